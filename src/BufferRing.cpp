@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <cstdlib>
+
+#include "BufferRing.h"
+#include "LogHelper.h"
+
+// Allocates 'count' buffers of 'bufferSize' bytes (rounded up to ALIGNMENT).
+// On failure nothing is kept and isValid() returns false.
+BufferRing::BufferRing(size_t count, size_t bufferSize) {
+	if (count == 0)
+		count = 1;
+	m_bufferSize = (bufferSize + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+	for (size_t i = 0; i < count; ++i) {
+		// aligned_alloc requires size to be a multiple of alignment
+		void *ptr = std::aligned_alloc(ALIGNMENT, m_bufferSize);
+		if (!ptr) {
+			LOG(LogLevel::ERROR) << "Buffer allocation failed:" << count << "x" << m_bufferSize << "bytes";
+			for (char *buf : m_buffers) {
+				std::free(buf);
+			}
+			m_buffers.clear();
+			return;
+		}
+		m_buffers.push_back(static_cast<char *>(ptr));
+	}
+	m_lengths.resize(count, 0);
+	m_chunkSize = m_bufferSize;
+}
+
+BufferRing::~BufferRing() {
+	for (char *buf : m_buffers) {
+		std::free(buf);
+	}
+}
+
+void BufferRing::setChunkSize(size_t size) {
+	size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+	m_chunkSize = std::clamp(size, ALIGNMENT, m_bufferSize);
+}
+
+void BufferRing::reset() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_head = 0;
+	m_tail = 0;
+	m_filled = 0;
+	m_occupied = 0;
+	m_finished = false;
+	m_closed = false;
+	m_error = 0;
+}
+
+char *BufferRing::acquireFree() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_cond.wait(lock, [this] { return m_closed || m_occupied < m_buffers.size(); });
+	if (m_closed)
+		return nullptr;
+	return m_buffers[m_head];
+}
+
+void BufferRing::commitFilled(size_t len) {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_lengths[m_head] = len;
+		m_head = (m_head + 1) % m_buffers.size();
+		m_filled++;
+		m_occupied++;
+	}
+	m_cond.notify_all();
+}
+
+void BufferRing::finish(int error) {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_finished = true;
+		m_error = error;
+	}
+	m_cond.notify_all();
+}
+
+bool BufferRing::acquireFilled(char *&data, size_t &len) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_cond.wait(lock, [this] { return m_closed || m_filled > 0 || m_finished; });
+	if (m_closed || m_filled == 0)
+		return false;
+
+	data = m_buffers[m_tail];
+	len = m_lengths[m_tail];
+	m_filled--;
+	return true;
+}
+
+void BufferRing::releaseFilled() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_tail = (m_tail + 1) % m_buffers.size();
+		m_occupied--;
+	}
+	m_cond.notify_all();
+}
+
+void BufferRing::close() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_closed = true;
+	}
+	m_cond.notify_all();
+}
+
+int BufferRing::error() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_error;
+}
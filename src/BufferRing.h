@@ -0,0 +1,76 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+// Fixed set of page-aligned buffers shared by the copy engines.
+// Allocated once per job so no engine has to malloc/free per file.
+//
+// It also works as a single-producer / single-consumer FIFO for the pipeline engine:
+// the reader thread fills free buffers and the writer (CopyWorker thread) hashes and
+// writes them in the same order. While one buffer is being written, the next ones are
+// already being read, so a copy between two devices runs at the speed of the slower
+// device instead of the sum of both latencies.
+class BufferRing {
+public:
+	// O_DIRECT requires buffers aligned to the logical block size
+	static constexpr size_t ALIGNMENT = 4096;
+
+	BufferRing(size_t count, size_t bufferSize);
+	~BufferRing();
+
+	BufferRing(const BufferRing &) = delete;
+	BufferRing &operator=(const BufferRing &) = delete;
+
+	// False if the allocation failed
+	bool isValid() const { return !m_buffers.empty(); }
+	size_t count() const { return m_buffers.size(); }
+	size_t bufferSize() const { return m_bufferSize; }
+	char *buffer(size_t index) const { return m_buffers[index]; }
+
+	// Amount of each buffer the engines fill per request (the buffer size autotuner lowers it).
+	// Rounded to ALIGNMENT and clamped to bufferSize(). Change it only between transfers.
+	size_t chunkSize() const { return m_chunkSize; }
+	void setChunkSize(size_t size);
+
+	// --- FIFO (one producer thread, one consumer thread) ---
+
+	// Empties the FIFO before a new transfer. No thread may be using it.
+	void reset();
+
+	// Producer: waits for a free buffer. Returns nullptr if the consumer closed the ring.
+	char *acquireFree();
+	// Producer: publishes the buffer returned by acquireFree() with 'len' valid bytes.
+	void commitFilled(size_t len);
+	// Producer: no more data will follow. 'error' is an errno value, 0 for a clean end.
+	void finish(int error);
+
+	// Consumer: waits for the next filled buffer. Returns false once the producer
+	// finished and everything was consumed.
+	bool acquireFilled(char *&data, size_t &len);
+	// Consumer: hands the buffer returned by acquireFilled() back to the producer.
+	void releaseFilled();
+	// Consumer: stops the transfer early and wakes the producer.
+	void close();
+
+	// errno passed to finish()
+	int error() const;
+
+private:
+	std::vector<char *> m_buffers;
+	std::vector<size_t> m_lengths;
+	size_t m_bufferSize = 0;
+	size_t m_chunkSize = 0;
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_cond;
+	size_t m_head = 0; // Next buffer to fill
+	size_t m_tail = 0; // Next buffer to consume
+	size_t m_filled = 0; // Buffers waiting for the consumer
+	size_t m_occupied = 0; // Filled buffers plus the one held by the consumer
+	bool m_finished = false;
+	bool m_closed = false;
+	int m_error = 0;
+};
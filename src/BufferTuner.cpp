@@ -0,0 +1,88 @@
+#include <algorithm>
+
+#include "BufferTuner.h"
+#include "LogHelper.h"
+
+// Data a candidate has to move before it is judged, and the minimum time it has to take
+// (a fast device finishes 64 MB in a few milliseconds, too short to time reliably)
+static constexpr uint64_t SAMPLE_BYTES = 64ull * 1024 * 1024;
+static constexpr double SAMPLE_SECONDS = 0.25;
+// A larger candidate this much slower than the best so far ends the tuning
+static constexpr double SLOWER_RATIO = 0.9;
+
+BufferTuner::BufferTuner(size_t maxSize) {
+	for (size_t size = 256 * 1024; size < maxSize; size *= 4) {
+		m_candidates.push_back(size);
+	}
+	m_candidates.push_back(maxSize);
+}
+
+void BufferTuner::setKnown(const std::string &devices, size_t size) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	Pair &pair = m_pairs[devices];
+	pair.done = true;
+	pair.best = std::min(size, m_candidates.back());
+}
+
+size_t BufferTuner::chunkSize(const std::string &devices, bool persistent) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	Pair &pair = m_pairs[devices];
+	pair.persistent = persistent;
+	if (pair.results.empty())
+		pair.results.resize(m_candidates.size());
+	return pair.done ? pair.best : m_candidates[pair.candidate];
+}
+
+void BufferTuner::addSample(const std::string &devices, size_t chunkSize, uint64_t bytes, double seconds) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto it = m_pairs.find(devices);
+	if (it == m_pairs.end())
+		return;
+	Pair &pair = it->second;
+	if (pair.done || chunkSize != m_candidates[pair.candidate])
+		return;
+
+	Measurement &current = pair.results[pair.candidate];
+	current.bytes += bytes;
+	current.seconds += seconds;
+	if (current.bytes < SAMPLE_BYTES || current.seconds < SAMPLE_SECONDS)
+		return;
+
+	// Past the peak: larger requests only get slower from here
+	double best = 0;
+	for (size_t i = 0; i < pair.candidate; ++i) {
+		best = std::max(best, pair.results[i].throughput());
+	}
+	if (pair.candidate > 0 && current.throughput() < best * SLOWER_RATIO) {
+		finish(devices, pair);
+		return;
+	}
+
+	if (++pair.candidate == m_candidates.size()) {
+		finish(devices, pair);
+	}
+}
+
+// Must be called with m_mutex held.
+void BufferTuner::finish(const std::string &devices, Pair &pair) {
+	size_t bestIndex = 0;
+	for (size_t i = 1; i < pair.results.size(); ++i) {
+		if (pair.results[i].throughput() > pair.results[bestIndex].throughput())
+			bestIndex = i;
+	}
+	pair.best = m_candidates[bestIndex];
+	pair.done = true;
+
+	LOG(LogLevel::INFO) << "Buffer size for" << QString::fromStdString(devices) << ":" << pair.best / 1024 << "KB"
+						<< "(" << pair.results[bestIndex].throughput() / (1024 * 1024) << "MB/s )";
+}
+
+std::map<std::string, size_t> BufferTuner::chosenSizes(bool persistentOnly) const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	std::map<std::string, size_t> sizes;
+	for (const auto &[devices, pair] : m_pairs) {
+		if (pair.done && (pair.persistent || !persistentOnly))
+			sizes[devices] = pair.best;
+	}
+	return sizes;
+}
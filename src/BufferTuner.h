@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Picks the chunk size per device pair from measured throughput.
+// USB 2 sticks, SATA disks, NVMe drives and FUSE mounts peak at very different request sizes,
+// so one static BUFFER_SIZE is wrong for most of them.
+//
+// The candidates go from 256 KB up to the allocated buffer size in steps of 4x. The first files
+// copied between a pair of devices are each copied with the current candidate and timed; once a
+// candidate has seen enough data the next one is tried. Tuning stops at the last candidate or as
+// soon as a larger size is clearly slower, and the fastest size is used from then on.
+// Thread safe: the pool workers share one tuner.
+class BufferTuner {
+public:
+	explicit BufferTuner(size_t maxSize);
+
+	// Size found by an earlier job: used right away, no measuring.
+	void setKnown(const std::string &devices, size_t size);
+
+	// Chunk size for the next file copied between 'devices'. 'persistent': the name stays the
+	// same in later sessions, so the size found may be saved for them.
+	size_t chunkSize(const std::string &devices, bool persistent);
+
+	// Reports a file copied with 'chunkSize'. Samples of an outdated candidate are ignored.
+	void addSample(const std::string &devices, size_t chunkSize, uint64_t bytes, double seconds);
+
+	// Device pairs with a chosen size (tuned in this job or known before).
+	// 'persistentOnly': just the pairs whose names can be saved.
+	std::map<std::string, size_t> chosenSizes(bool persistentOnly) const;
+
+	// Files smaller than this tell more about per-file overhead than about the chunk size
+	static uint64_t minSampleFileSize(size_t chunkSize) { return 8 * (uint64_t)chunkSize; }
+
+private:
+	struct Measurement {
+		uint64_t bytes = 0;
+		double seconds = 0;
+		double throughput() const { return seconds > 0 ? bytes / seconds : 0; }
+	};
+
+	struct Pair {
+		size_t candidate = 0; // Index in m_candidates being measured
+		std::vector<Measurement> results;
+		bool done = false;
+		size_t best = 0;
+		bool persistent = true;
+	};
+
+	std::vector<size_t> m_candidates;
+	std::map<std::string, Pair> m_pairs;
+	mutable std::mutex m_mutex;
+
+	void finish(const std::string &devices, Pair &pair);
+};
@@ -0,0 +1,50 @@
+#include <algorithm>
+
+#include "ChunkHasher.h"
+
+ChunkHasher::ChunkHasher(Config::HashAlgorithm algorithm, bool keepBlocks) : m_file(Hasher::create(algorithm)) {
+	if (keepBlocks) {
+		m_blockState = XXH3_createState();
+		XXH3_64bits_reset(m_blockState);
+	}
+}
+
+ChunkHasher::~ChunkHasher() {
+	if (m_blockState)
+		XXH3_freeState(m_blockState);
+}
+
+void ChunkHasher::update(const void *data, size_t len) {
+	m_file->update(data, len);
+	if (!m_blockState)
+		return;
+
+	// Split the chunk at block boundaries
+	const char *p = static_cast<const char *>(data);
+	while (len > 0) {
+		size_t n = std::min(len, HASH_BLOCK_SIZE - m_blockFill);
+		XXH3_64bits_update(m_blockState, p, n);
+		m_blockFill += n;
+		p += n;
+		len -= n;
+
+		if (m_blockFill == HASH_BLOCK_SIZE) {
+			m_blocks.push_back(XXH3_64bits_digest(m_blockState));
+			XXH3_64bits_reset(m_blockState);
+			m_blockFill = 0;
+		}
+	}
+}
+
+uint64_t ChunkHasher::rootOf(const std::vector<uint64_t> &blocks) {
+	return XXH3_64bits(blocks.data(), blocks.size() * sizeof(uint64_t));
+}
+
+Hasher::Digest ChunkHasher::digest() {
+	if (m_blockState && m_blockFill > 0) {
+		m_blocks.push_back(XXH3_64bits_digest(m_blockState));
+		XXH3_64bits_reset(m_blockState);
+		m_blockFill = 0;
+	}
+	return m_file->digest();
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <xxhash.h>
+
+#include "Hasher.h"
+
+// Streaming hash of one file as it is copied.
+// Always produces the checksum of the whole file with the chosen algorithm (history, full
+// verification). With keepBlocks it also keeps an XXH3 hash of every HASH_BLOCK_SIZE block,
+// so a single block of the destination can be checked (sampling, hash tree, repair) without
+// reading the rest of the file.
+// Data must be passed in file order; the chunks don't have to line up with the blocks.
+class ChunkHasher {
+public:
+	// Multiple of the O_DIRECT alignment, so every block starts on an aligned offset
+	static constexpr size_t HASH_BLOCK_SIZE = 1024 * 1024;
+
+	ChunkHasher(Config::HashAlgorithm algorithm, bool keepBlocks);
+	~ChunkHasher();
+
+	ChunkHasher(const ChunkHasher &) = delete;
+	ChunkHasher &operator=(const ChunkHasher &) = delete;
+
+	void update(const void *data, size_t len);
+
+	// Checksum of everything passed to update(). Also closes the last, partial block.
+	Hasher::Digest digest();
+
+	// One hash per block, valid after digest(). Empty without keepBlocks.
+	std::vector<uint64_t> takeBlockHashes() { return std::move(m_blocks); }
+
+	// Number of blocks of a file of 'size' bytes
+	static uint64_t blockCount(uint64_t size) { return (size + HASH_BLOCK_SIZE - 1) / HASH_BLOCK_SIZE; }
+
+	// Root of the hash tree (HASH_TREE): XXH3 over the block hashes in file order.
+	// The same root from both sides means every block matches.
+	static uint64_t rootOf(const std::vector<uint64_t> &blocks);
+
+private:
+	std::unique_ptr<Hasher> m_file;
+	XXH3_state_t *m_blockState = nullptr; // Null without keepBlocks
+	size_t m_blockFill = 0; // Bytes of the current block hashed so far
+	std::vector<uint64_t> m_blocks;
+};
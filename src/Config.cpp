@@ -12,6 +12,34 @@ namespace Config {
 		SANITIZE_FILENAMES = s.value("sanitizeFilenames", Defaults::SANITIZE_FILENAMES).toBool();
 		DISK_SPACE_SAFETY_MARGIN = s.value("diskSafetyMarginMB", Defaults::DISK_SPACE_SAFETY_MARGIN_MB).toInt() * 1024 * 1024;
 		BUFFER_SIZE = s.value("bufferSizeMB", Defaults::BUFFER_SIZE_MB).toInt() * 1024 * 1024;
+		COPY_ENGINE = static_cast<CopyEngine>(s.value("copyEngine", static_cast<int>(Defaults::COPY_ENGINE)).toInt());
+		HASH_ALGORITHM = static_cast<HashAlgorithm>(s.value("hashAlgorithm", static_cast<int>(Defaults::HASH_ALGORITHM)).toInt());
+		WRITE_HASH_MANIFEST = s.value("writeHashManifest", Defaults::WRITE_HASH_MANIFEST).toBool();
+		HASH_CACHE = s.value("hashCache", Defaults::HASH_CACHE).toBool();
+		IO_QUEUE_DEPTH = s.value("ioQueueDepth", Defaults::IO_QUEUE_DEPTH).toInt();
+		REFLINK_ENABLED = s.value("reflinkEnabled", Defaults::REFLINK_ENABLED).toBool();
+		DIRECT_WRITE_ENABLED = s.value("directWriteEnabled", Defaults::DIRECT_WRITE_ENABLED).toBool();
+		DIRECT_WRITE_THRESHOLD_MB = s.value("directWriteThresholdMB", Defaults::DIRECT_WRITE_THRESHOLD_MB).toInt();
+		PREALLOCATE_ENABLED = s.value("preallocateEnabled", Defaults::PREALLOCATE_ENABLED).toBool();
+		RESERVE_JOB_SPACE = s.value("reserveJobSpace", Defaults::RESERVE_JOB_SPACE).toBool();
+		SPARSE_FILES_ENABLED = s.value("sparseFilesEnabled", Defaults::SPARSE_FILES_ENABLED).toBool();
+		SPARSIFY_ZERO_RUNS = s.value("sparsifyZeroRuns", Defaults::SPARSIFY_ZERO_RUNS).toBool();
+		PARALLEL_COPY_THREADS = s.value("parallelCopyThreads", Defaults::PARALLEL_COPY_THREADS).toInt();
+		PARALLEL_COPY_THRESHOLD_MB = s.value("parallelCopyThresholdMB", Defaults::PARALLEL_COPY_THRESHOLD_MB).toInt();
+		COPY_THREADS = s.value("copyThreads", Defaults::COPY_THREADS).toInt();
+		HDD_WINDOW_MB = s.value("hddWindowMB", Defaults::HDD_WINDOW_MB).toInt();
+		ORDER_BY_PHYSICAL_LOCATION = s.value("orderByPhysicalLocation", Defaults::ORDER_BY_PHYSICAL_LOCATION).toBool();
+		BUFFER_AUTOTUNE = s.value("bufferAutotune", Defaults::BUFFER_AUTOTUNE).toBool();
+		WRITEBACK_WINDOW_MB = s.value("writebackWindowMB", Defaults::WRITEBACK_WINDOW_MB).toInt();
+		VERIFY_GROUP_MB = s.value("verifyGroupMB", Defaults::VERIFY_GROUP_MB).toInt();
+		VERIFY_GROUP_FILES = s.value("verifyGroupFiles", Defaults::VERIFY_GROUP_FILES).toInt();
+		ASYNC_VERIFY = s.value("asyncVerify", Defaults::ASYNC_VERIFY).toBool();
+		SAMPLED_VERIFY = s.value("sampledVerify", Defaults::SAMPLED_VERIFY).toBool();
+		VERIFY_SAMPLE_PERCENT = s.value("verifySamplePercent", Defaults::VERIFY_SAMPLE_PERCENT).toInt();
+		VERIFY_SAMPLE_MIN_MB = s.value("verifySampleMinMB", Defaults::VERIFY_SAMPLE_MIN_MB).toInt();
+		HASH_TREE = s.value("hashTree", Defaults::HASH_TREE).toBool();
+		REPAIR_ENABLED = s.value("repairEnabled", Defaults::REPAIR_ENABLED).toBool();
+		REPAIR_MAX_RETRIES = s.value("repairMaxRetries", Defaults::REPAIR_MAX_RETRIES).toInt();
 		DRY_RUN = s.value("dryRun", Defaults::DRY_RUN).toBool();
 		DRY_RUN_FILE_SIZE = s.value("dryRunFileSizeMB", Defaults::DRY_RUN_FILE_SIZE_MB).toULongLong() * 1024 * 1024;
 		DRY_RUN_FILL_TARGET = s.value("dryRunFillTargetMB", Defaults::DRY_RUN_FILL_TARGET_MB).toULongLong() * 1024 * 1024;
@@ -36,6 +64,34 @@ namespace Config {
 		s.setValue("sanitizeFilenames", SANITIZE_FILENAMES);
 		s.setValue("diskSafetyMarginMB", (int)(DISK_SPACE_SAFETY_MARGIN / (1024 * 1024)));
 		s.setValue("bufferSizeMB", (int)(BUFFER_SIZE / (1024 * 1024)));
+		s.setValue("copyEngine", static_cast<int>(COPY_ENGINE));
+		s.setValue("hashAlgorithm", static_cast<int>(HASH_ALGORITHM));
+		s.setValue("writeHashManifest", WRITE_HASH_MANIFEST);
+		s.setValue("hashCache", HASH_CACHE);
+		s.setValue("ioQueueDepth", IO_QUEUE_DEPTH);
+		s.setValue("reflinkEnabled", REFLINK_ENABLED);
+		s.setValue("directWriteEnabled", DIRECT_WRITE_ENABLED);
+		s.setValue("directWriteThresholdMB", DIRECT_WRITE_THRESHOLD_MB);
+		s.setValue("preallocateEnabled", PREALLOCATE_ENABLED);
+		s.setValue("reserveJobSpace", RESERVE_JOB_SPACE);
+		s.setValue("sparseFilesEnabled", SPARSE_FILES_ENABLED);
+		s.setValue("sparsifyZeroRuns", SPARSIFY_ZERO_RUNS);
+		s.setValue("parallelCopyThreads", PARALLEL_COPY_THREADS);
+		s.setValue("parallelCopyThresholdMB", PARALLEL_COPY_THRESHOLD_MB);
+		s.setValue("copyThreads", COPY_THREADS);
+		s.setValue("hddWindowMB", HDD_WINDOW_MB);
+		s.setValue("orderByPhysicalLocation", ORDER_BY_PHYSICAL_LOCATION);
+		s.setValue("bufferAutotune", BUFFER_AUTOTUNE);
+		s.setValue("writebackWindowMB", WRITEBACK_WINDOW_MB);
+		s.setValue("verifyGroupMB", VERIFY_GROUP_MB);
+		s.setValue("verifyGroupFiles", VERIFY_GROUP_FILES);
+		s.setValue("asyncVerify", ASYNC_VERIFY);
+		s.setValue("sampledVerify", SAMPLED_VERIFY);
+		s.setValue("verifySamplePercent", VERIFY_SAMPLE_PERCENT);
+		s.setValue("verifySampleMinMB", VERIFY_SAMPLE_MIN_MB);
+		s.setValue("hashTree", HASH_TREE);
+		s.setValue("repairEnabled", REPAIR_ENABLED);
+		s.setValue("repairMaxRetries", REPAIR_MAX_RETRIES);
 		s.setValue("dryRun", DRY_RUN);
 		s.setValue("dryRunFileSizeMB", (qint64)(DRY_RUN_FILE_SIZE / (1024 * 1024)));
 		s.setValue("dryRunFillTargetMB", (qint64)(DRY_RUN_FILL_TARGET / (1024 * 1024)));
@@ -49,4 +105,37 @@ namespace Config {
 		s.setValue("uiStyle", UI_STYLE);
 		s.setValue("language", LANGUAGE);
 	}
-} // namespace Config
\ No newline at end of file
+
+	QMap<QString, int> loadTunedBufferSizes() {
+		QSettings s;
+		QMap<QString, int> sizes;
+		// An array rather than one key per pair: the names contain spaces and '>'
+		int count = s.beginReadArray("tunedBufferSizes");
+		for (int i = 0; i < count; ++i) {
+			s.setArrayIndex(i);
+			sizes[s.value("devices").toString()] = s.value("size").toInt();
+		}
+		s.endArray();
+		return sizes;
+	}
+
+	void saveTunedBufferSize(const QString &devices, int size) {
+		QMap<QString, int> sizes = loadTunedBufferSizes();
+		sizes[devices] = size;
+
+		QSettings s;
+		s.beginWriteArray("tunedBufferSizes", sizes.size());
+		int i = 0;
+		for (auto it = sizes.begin(); it != sizes.end(); ++it, ++i) {
+			s.setArrayIndex(i);
+			s.setValue("devices", it.key());
+			s.setValue("size", it.value());
+		}
+		s.endArray();
+	}
+
+	void clearTunedBufferSizes() {
+		QSettings s;
+		s.remove("tunedBufferSizes");
+	}
+} // namespace Config
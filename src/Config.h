@@ -1,5 +1,6 @@
 #pragma once
 
+#include <QMap>
 #include <QString>
 #include <cstdint>
 
@@ -16,6 +17,30 @@ namespace Constants {
 } // namespace Constants
 
 namespace Config {
+	// Data path used by CopyWorker to move file contents.
+	// Auto uses copy_file_range when checksums are off, mmap for local sources that are
+	// already in the page cache, otherwise io_uring when the kernel supports it,
+	// and falls back to the reader/writer pipeline.
+	// Values are stored in the settings file, only append new engines.
+	enum class CopyEngine {
+		Auto,
+		ReadWrite,
+		IoUring,
+		CopyFileRange,
+		Pipeline, // Reader thread + writer thread over the buffer ring
+		Mmap // Hash and write straight from a mapping of the source
+	};
+
+	// Checksum used to verify copies (see Hasher).
+	// Values are stored in the settings file, only append new algorithms.
+	enum class HashAlgorithm {
+		XXH64,
+		XXH3_64,
+		XXH3_128,
+		CRC32C,
+		BLAKE3 // Only when built with libblake3
+	};
+
 	namespace Defaults {
 		inline constexpr bool LOG_HISTORY_ENABLED = true;
 		inline constexpr bool CLOSE_ON_FINISH = false;
@@ -24,6 +49,34 @@ namespace Config {
 		inline constexpr bool SANITIZE_FILENAMES = true;
 		inline constexpr int DISK_SPACE_SAFETY_MARGIN_MB = 50;
 		inline constexpr int BUFFER_SIZE_MB = 8;
+		inline constexpr CopyEngine COPY_ENGINE = CopyEngine::Auto;
+		inline constexpr HashAlgorithm HASH_ALGORITHM = HashAlgorithm::XXH64;
+		inline constexpr bool WRITE_HASH_MANIFEST = false;
+		inline constexpr bool HASH_CACHE = false;
+		inline constexpr int IO_QUEUE_DEPTH = 4;
+		inline constexpr bool REFLINK_ENABLED = true;
+		inline constexpr bool DIRECT_WRITE_ENABLED = false;
+		inline constexpr int DIRECT_WRITE_THRESHOLD_MB = 256;
+		inline constexpr bool PREALLOCATE_ENABLED = true;
+		inline constexpr bool RESERVE_JOB_SPACE = false;
+		inline constexpr bool SPARSE_FILES_ENABLED = true;
+		inline constexpr bool SPARSIFY_ZERO_RUNS = false;
+		inline constexpr int PARALLEL_COPY_THREADS = 4;
+		inline constexpr int PARALLEL_COPY_THRESHOLD_MB = 1024;
+		inline constexpr int COPY_THREADS = 1;
+		inline constexpr int HDD_WINDOW_MB = 256;
+		inline constexpr bool ORDER_BY_PHYSICAL_LOCATION = false;
+		inline constexpr bool BUFFER_AUTOTUNE = true;
+		inline constexpr int WRITEBACK_WINDOW_MB = 32;
+		inline constexpr int VERIFY_GROUP_MB = 64;
+		inline constexpr int VERIFY_GROUP_FILES = 256;
+		inline constexpr bool ASYNC_VERIFY = true;
+		inline constexpr bool SAMPLED_VERIFY = false;
+		inline constexpr int VERIFY_SAMPLE_PERCENT = 5;
+		inline constexpr int VERIFY_SAMPLE_MIN_MB = 64;
+		inline constexpr bool HASH_TREE = false;
+		inline constexpr bool REPAIR_ENABLED = true;
+		inline constexpr int REPAIR_MAX_RETRIES = 3;
 		inline constexpr bool DRY_RUN = false;
 		inline constexpr int DRY_RUN_FILE_SIZE_MB = 10;
 		inline constexpr int DRY_RUN_FILL_TARGET_MB = 0;
@@ -115,7 +168,7 @@ namespace Config {
 	// User Control: Users with high-speed NVMe drives might set the threshold to 0MB 
 	// to verify everything from disk, while users with slow HDD/USB drives 
 	// can set it higher to maintain responsiveness.
-	inline int SYNC_THRESHOLD_MB = Defaults::SYNC_THRESHOLD_MB * 1024 * 1024;
+	inline int SYNC_THRESHOLD_MB = Defaults::SYNC_THRESHOLD_MB;
 
 	// Select files in file manager after copy
 	inline bool SELECT_FILES_AFTER_COPY = Defaults::SELECT_FILES_AFTER_COPY;
@@ -131,6 +184,110 @@ namespace Config {
 	// CPU's L3 cache, which can actually slow down the checksum calculation (XXH64_update).
 	inline size_t BUFFER_SIZE = Defaults::BUFFER_SIZE_MB * 1024 * 1024;
 
+	// Depth of the buffer ring: number of BUFFER_SIZE chunks the io_uring and pipeline
+	// engines keep in flight. Higher values help fast NVMe drives which only saturate
+	// at high queue depth, at the cost of IO_QUEUE_DEPTH * BUFFER_SIZE of memory.
+	inline int IO_QUEUE_DEPTH = Defaults::IO_QUEUE_DEPTH;
+
+	// Engine used for the copy and verify loops
+	inline CopyEngine COPY_ENGINE = Defaults::COPY_ENGINE;
+
+	// Algorithm of the file checksums, recorded with every job in the history
+	inline HashAlgorithm HASH_ALGORITHM = Defaults::HASH_ALGORITHM;
+
+	// Write the checksums of the job to Movero_<date>.<algorithm> in the destination folder
+	// (xxhsum/b3sum format). "movero verify <manifest>" checks the files against it later.
+	inline bool WRITE_HASH_MANIFEST = Defaults::WRITE_HASH_MANIFEST;
+
+	// Remember the checksum of each verified source (in a user.movero.* xattr, or an index in the
+	// app data folder) and reuse it while the file keeps its size and mtime. Copying the same
+	// files to another disk then doesn't hash the source again.
+	inline bool HASH_CACHE = Defaults::HASH_CACHE;
+
+	// Clone files with FICLONE when source and destination share a btrfs/XFS filesystem.
+	// The extents are shared instead of copied, so there is nothing to hash or verify.
+	inline bool REFLINK_ENABLED = Defaults::REFLINK_ENABLED;
+
+	// Write files of at least DIRECT_WRITE_THRESHOLD_MB with O_DIRECT, bypassing the page cache.
+	// Keeps throughput flat on multi-TB jobs and avoids evicting other programs' cache,
+	// but small files are faster through the cache.
+	inline bool DIRECT_WRITE_ENABLED = Defaults::DIRECT_WRITE_ENABLED;
+	inline int DIRECT_WRITE_THRESHOLD_MB = Defaults::DIRECT_WRITE_THRESHOLD_MB;
+
+	// fallocate() each destination file to its final size right after opening it.
+	// Gives contiguous extents and reports a full disk before the copy starts.
+	inline bool PREALLOCATE_ENABLED = Defaults::PREALLOCATE_ENABLED;
+
+	// Reserve the space for the whole job before copying the first file
+	// (a hidden file in the destination that shrinks as files are written).
+	// The job then either fails at the start or never runs out of space.
+	inline bool RESERVE_JOB_SPACE = Defaults::RESERVE_JOB_SPACE;
+
+	// Keep the holes of sparse files (VM images, databases) instead of writing them out as zeros
+	inline bool SPARSE_FILES_ENABLED = Defaults::SPARSE_FILES_ENABLED;
+
+	// Also turn all-zero blocks of any file into holes on the destination
+	inline bool SPARSIFY_ZERO_RUNS = Defaults::SPARSIFY_ZERO_RUNS;
+
+	// Files of at least PARALLEL_COPY_THRESHOLD_MB are copied by several threads, each on its
+	// own range. NVMe drives only reach full speed with many requests in flight.
+	// Limited by IO_QUEUE_DEPTH (one ring buffer per thread). 1 disables it.
+	inline int PARALLEL_COPY_THREADS = Defaults::PARALLEL_COPY_THREADS;
+	inline int PARALLEL_COPY_THRESHOLD_MB = Defaults::PARALLEL_COPY_THRESHOLD_MB;
+
+	// Number of files copied at the same time. Helps most with many small files, where the
+	// time per file (open, sync, close) matters more than the throughput. 1 copies one by one.
+	// Each thread allocates its own IO_QUEUE_DEPTH * BUFFER_SIZE of buffers.
+	inline int COPY_THREADS = Defaults::COPY_THREADS;
+
+	// Source and destination on the same spinning disk: read this much, then write it in one
+	// burst, instead of seeking between the two for every buffer. Taken from RAM per copying
+	// thread that hits such a file, for the rest of the job. 0 disables it.
+	inline int HDD_WINDOW_MB = Defaults::HDD_WINDOW_MB;
+
+	// Copy the files in the order they are stored on the source disk (first extent, else inode)
+	// instead of directory order. Turns the seeks between files on hard drives and fragmented
+	// filesystems into one sweep. Costs an open() per file while scanning.
+	inline bool ORDER_BY_PHYSICAL_LOCATION = Defaults::ORDER_BY_PHYSICAL_LOCATION;
+
+	// Measure the throughput of several chunk sizes on the first files of each pair of devices
+	// and keep the fastest. BUFFER_SIZE becomes the upper limit. The result is saved per device
+	// pair (see loadTunedBufferSizes) and reused by later jobs without measuring again, except for
+	// devices without a sysfs node, whose names don't survive a reboot: those are tuned per job.
+	inline bool BUFFER_AUTOTUNE = Defaults::BUFFER_AUTOTUNE;
+
+	// Start the writeback of every WRITEBACK_WINDOW_MB written and wait for the previous one,
+	// so dirty pages never pile up (the desktop freezes while the kernel flushes gigabytes to a
+	// slow USB disk). 0 leaves the writeback to the kernel.
+	inline int WRITEBACK_WINDOW_MB = Defaults::WRITEBACK_WINDOW_MB;
+
+	// Files below SYNC_THRESHOLD_MB are not synced one by one. They are collected until the group
+	// holds VERIFY_GROUP_MB or VERIFY_GROUP_FILES, then one syncfs() writes all of them and each
+	// is verified from the disk. In Move mode the sources are only removed after that.
+	inline int VERIFY_GROUP_MB = Defaults::VERIFY_GROUP_MB;
+	inline int VERIFY_GROUP_FILES = Defaults::VERIFY_GROUP_FILES;
+
+	// Verify on a separate thread while the next file is copied. Off, or with the destination
+	// on a spinning disk, each file is verified before the next one starts.
+	inline bool ASYNC_VERIFY = Defaults::ASYNC_VERIFY;
+
+	// Verify files of VERIFY_SAMPLE_MIN_MB and more by reading back VERIFY_SAMPLE_PERCENT of
+	// their 1 MB blocks (chosen at random) instead of the whole file. Each block is compared with
+	// its own hash taken while copying. Smaller files are still verified in full.
+	inline bool SAMPLED_VERIFY = Defaults::SAMPLED_VERIFY;
+	inline int VERIFY_SAMPLE_PERCENT = Defaults::VERIFY_SAMPLE_PERCENT;
+	inline int VERIFY_SAMPLE_MIN_MB = Defaults::VERIFY_SAMPLE_MIN_MB;
+
+	// Hash every 1 MB block and combine the block hashes into a root instead of one XXH64 stream.
+	// Large files are then verified by several threads (PARALLEL_COPY_THREADS) at once, and a
+	// mismatch reports the damaged byte ranges. The root is the hash shown in the history.
+	inline bool HASH_TREE = Defaults::HASH_TREE;
+
+	// On a checksum mismatch, rewrite only the damaged 1 MB blocks from the source and read them
+	// back, up to REPAIR_MAX_RETRIES times, instead of deleting the whole destination.
+	inline bool REPAIR_ENABLED = Defaults::REPAIR_ENABLED;
+	inline int REPAIR_MAX_RETRIES = Defaults::REPAIR_MAX_RETRIES;
+
 	// Interval at which the copy worker sends data to main thread
 	inline constexpr double SPEED_UPDATE_INTERVAL = 0.05; // 50ms (20Hz)
 
@@ -139,4 +296,10 @@ namespace Config {
 
 	void load();
 	void save();
+
+	// Chunk sizes found by the autotuner, by device pair ("sdb -> nvme0n1"), in bytes.
+	// Kept apart from load()/save() so the copy thread can update them.
+	QMap<QString, int> loadTunedBufferSizes();
+	void saveTunedBufferSize(const QString &devices, int size);
+	void clearTunedBufferSizes();
 } // namespace Config
\ No newline at end of file
@@ -1,17 +1,39 @@
 #include <QDateTime>
+#include <QDir>
 #include <QRegularExpression>
+#include <QStandardPaths>
 #include <QStorageInfo>
 #include <algorithm>
+#include <cerrno>
+#include <cstdio>
 #include <cstdlib>
+#include <csetjmp>
+#include <csignal>
+#include <cstring>
 #include <fcntl.h>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <thread>
+#include <tuple>
 #include <unistd.h>
 #include <xxhash.h>
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+#include <linux/magic.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/vfs.h>
 
 #include "Config.h"
 #include "CopyWorker.h"
+#include "IoScheduler.h"
 #include "LogHelper.h"
+#include "UringEngine.h"
+#include "WorkStealingQueue.h"
 
 namespace fs = std::filesystem;
 
@@ -28,11 +50,28 @@ CopyWorker::CopyWorker(const std::vector<std::string> &sources, const std::strin
 
 // Pauses the copy operation.
 void CopyWorker::pause() {
+	QMutexLocker locker(&m_progressMutex);
+	if (!m_paused)
+		m_pauseStart = std::chrono::steady_clock::now();
 	m_paused = true;
 }
 
 // Resumes the copy operation if it was paused.
+// The paused time is excluded from the average speed and ETA.
 void CopyWorker::resume() {
+	{
+		QMutexLocker progressLocker(&m_progressMutex);
+		if (m_paused) {
+			auto now = std::chrono::steady_clock::now();
+			m_totalPausedDuration += (now - m_pauseStart);
+
+			// Reset the sampling clock so the pause duration isn't
+			// counted as "active time" in the next speed calculation.
+			m_lastSampleTime = now;
+			m_lastTotalBytesProcessed = m_totalBytesProcessed;
+		}
+	}
+
 	QMutexLocker locker(&m_sync);
 	m_paused = false;
 	m_pauseCond.wakeAll();
@@ -42,6 +81,7 @@ void CopyWorker::resume() {
 void CopyWorker::cancel() {
 	m_cancelled = true;
 	resume(); // Break wait if paused
+	m_scheduler.wakeAll(); // Break wait for a busy disk
 
 	QMutexLocker locker(&m_inputMutex);
 	m_inputWait.wakeAll(); // Break wait if waiting for user input
@@ -93,8 +133,10 @@ static fs::path generateAutoRename(const fs::path &path) {
 }
 
 // Calculates current speed, average speed, and ETA, then emits progress signals to the UI.
+// Called by every pool worker, the first one due after SPEED_UPDATE_INTERVAL reports.
 void CopyWorker::updateProgress(const fs::path &src, const fs::path &dest, qint64 fileRead, qint64 fileSize)
 {
+	QMutexLocker locker(&m_progressMutex);
 	auto now = std::chrono::steady_clock::now();
 	std::chrono::duration<double> elapsedSinceLast = now - m_lastSampleTime;
 
@@ -226,6 +268,65 @@ static std::string sanitizeFilename(const std::string &name, CopyWorker::FileSys
 	return result;
 }
 
+// Jump target, set only while this thread reads an mmap'ed source in userspace.
+// Touching a page beyond EOF (file truncated by another program while we copy it)
+// raises SIGBUS. The handler turns that into a read error instead of a crash.
+static thread_local sigjmp_buf *t_sigbusJump = nullptr;
+
+static void onSigbus(int sig) {
+	if (t_sigbusJump) {
+		siglongjmp(*t_sigbusJump, 1);
+	}
+	// Not ours: default action
+	signal(sig, SIG_DFL);
+	raise(sig);
+}
+
+void CopyWorker::installSigbusHandler() {
+	struct sigaction sa = {};
+	sa.sa_handler = onSigbus;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGBUS, &sa, nullptr);
+}
+
+// Network and FUSE filesystems: page faults on a mapping are round trips (or worse,
+// SIGBUS on a dropped connection), read() with readahead is faster there.
+static bool isLocalFileSystem(int fd) {
+	struct statfs sfs;
+	if (fstatfs(fd, &sfs) != 0)
+		return false;
+
+	switch (static_cast<unsigned long>(sfs.f_type)) {
+		case 0x65735546: // FUSE
+		case NFS_SUPER_MAGIC:
+		case SMB_SUPER_MAGIC:
+		case 0xFF534D42: // CIFS
+		case 0xFE534D42: // SMB2
+		case 0x00C36400: // Ceph
+		case V9FS_MAGIC:
+			return false;
+		default:
+			return true;
+	}
+}
+
+// Fraction of the mapped file that is already in the page cache, sampled at up to 256 pages.
+static double residentFraction(void *map, size_t size) {
+	const size_t pageSize = sysconf(_SC_PAGESIZE);
+	const size_t pages = (size + pageSize - 1) / pageSize;
+	const size_t samples = std::min<size_t>(pages, 256);
+	size_t resident = 0;
+
+	for (size_t i = 0; i < samples; ++i) {
+		size_t page = i * pages / samples;
+		unsigned char vec = 0;
+		if (mincore(static_cast<char *>(map) + page * pageSize, pageSize, &vec) == 0 && (vec & 1)) {
+			resident++;
+		}
+	}
+	return samples ? static_cast<double>(resident) / samples : 0.0;
+}
+
 // Applies filename sanitization to an entire relative path structure.
 static fs::path getSanitizedRelativePath(const fs::path &relPath, CopyWorker::FileSystemType fsType) {
 	if (!Config::SANITIZE_FILENAMES)
@@ -242,9 +343,17 @@ static fs::path getSanitizedRelativePath(const fs::path &relPath, CopyWorker::Fi
 // creates directories, and iterates through file tasks.
 // "Copy -> Sync -> Verify" flow per-file
 void CopyWorker::run() {
+	if (m_mode == Compare) {
+		runCompare();
+		emit finished();
+		return;
+	}
+
 	std::vector<CopyTask> tasks;
 	std::vector<fs::path> sourceDirs; // To clean up empty folders in Move mode
 	uintmax_t totalBytesRequired = 0;
+	uintmax_t totalWorkBytes = 0; // Copying + Optional Verifying
+	uintmax_t sameDeviceBytes = 0; // Bytes that can be moved by rename and need no free space
 
 	// Determine the destination filesystem type to apply correct sanitization rules.
 	const CopyWorker::FileSystemType fsType = getFileSystemAt(m_destDir);
@@ -261,9 +370,11 @@ void CopyWorker::run() {
 				std::string name = "DRY_RUN_" + std::to_string(i + 1) + ".dat";
 				tasks.push_back({"DRY_RUN_SOURCE", fs::path(m_destDir) / name});
 				totalBytesRequired += fileSize;
+				totalWorkBytes += workBytes(fileSize);
 			}
 		} else {
 			totalBytesRequired = fileSize;
+			totalWorkBytes = workBytes(fileSize);
 			tasks.push_back({"DRY_RUN_SOURCE", fs::path(m_destDir) / "DRY_RUN.dat"});
 		}
 		emit statusChanged(DryRunGenerating);
@@ -273,6 +384,9 @@ void CopyWorker::run() {
 		// PHASE 1: Scan, Map, and Calculate Size
 		emit statusChanged(Scanning);
 
+		// In Move mode, sources on the destination filesystem are renamed instead of copied
+		struct stat destStat;
+		bool moveByRename = (m_mode == Move && stat(m_destDir.c_str(), &destStat) == 0);
 
 		for (const auto &srcStr : m_sources) {
 			fs::path srcRoot(srcStr);
@@ -288,15 +402,34 @@ void CopyWorker::run() {
 
 			fs::path base = srcRoot.parent_path();
 
+			bool sameDevice = false;
+			if (moveByRename) {
+				struct stat srcStat;
+				sameDevice = (lstat(srcRoot.c_str(), &srcStat) == 0 && srcStat.st_dev == destStat.st_dev);
+			}
+
+			// Same filesystem move: rename the whole tree at once.
+			// RENAME_NOREPLACE never overwrites anything. On a conflict (EEXIST) or a
+			// mount boundary (EXDEV) the tree is scanned and moved per file below.
+			if (sameDevice) {
+				fs::path rel = fs::relative(srcRoot, base);
+				fs::path rootDest = fs::path(m_destDir) / getSanitizedRelativePath(rel, fsType);
+				if (renameat2(AT_FDCWD, srcRoot.c_str(), AT_FDCWD, rootDest.c_str(), RENAME_NOREPLACE) == 0) {
+					tasks.push_back({srcRoot, rootDest, true, true, true});
+					continue;
+				}
+				LOG(LogLevel::DEBUG) << "Rename not possible (" << strerror(errno) << "), moving per file:" << srcRoot.c_str();
+			}
+
 			if (fs::is_symlink(srcRoot)) {
 				fs::path rel = fs::relative(srcRoot, base);
-				tasks.push_back({srcRoot, fs::path(m_destDir) / getSanitizedRelativePath(rel, fsType), true});
+				tasks.push_back({srcRoot, fs::path(m_destDir) / getSanitizedRelativePath(rel, fsType), true, sameDevice});
 
 			} else if (fs::is_directory(srcRoot)) {
 				sourceDirs.push_back(srcRoot);
 				fs::path rel = fs::relative(srcRoot, base);
 				fs::path destDir = fs::path(m_destDir) / getSanitizedRelativePath(rel, fsType);
-				tasks.push_back({srcRoot, destDir, true});
+				tasks.push_back({srcRoot, destDir, true, sameDevice});
 
 				// Use directory_options::follow_directory_symlink if you want to enter symlinked folders,
 				// but usually, for a backup, you want to copy the link itself.
@@ -320,31 +453,47 @@ void CopyWorker::run() {
 					// (to avoid trying to copy things like sockets or device files 
 					// which might exist in Linux systems).
 					if (fs::is_symlink(stat)) {
-						tasks.push_back({entryPath, taskDest, false});
+						tasks.push_back({entryPath, taskDest, false, sameDevice});
 					} else if (fs::is_directory(stat)) {
 						sourceDirs.push_back(entryPath);
-						tasks.push_back({entryPath, taskDest, false});
+						tasks.push_back({entryPath, taskDest, false, sameDevice});
 					} else if (fs::is_regular_file(stat)) {
-						totalBytesRequired += fs::file_size(entryPath);
-						tasks.push_back({entryPath, taskDest, false});
+						uintmax_t size = fs::file_size(entryPath);
+						totalBytesRequired += size;
+						totalWorkBytes += workBytes(size);
+						if (sameDevice)
+							sameDeviceBytes += size;
+						tasks.push_back({entryPath, taskDest, false, sameDevice});
 					}
 				}
 			} else {
-				totalBytesRequired += fs::file_size(srcRoot);
+				uintmax_t size = fs::file_size(srcRoot);
+				totalBytesRequired += size;
+				totalWorkBytes += workBytes(size);
+				if (sameDevice)
+					sameDeviceBytes += size;
 				fs::path rel = fs::relative(srcRoot, base);
-				tasks.push_back({srcRoot, fs::path(m_destDir) / getSanitizedRelativePath(rel, fsType), true});
+				tasks.push_back({srcRoot, fs::path(m_destDir) / getSanitizedRelativePath(rel, fsType), true, sameDevice});
 			}
 		}
 	}
 
+	// Read the files in the order they are stored on disk
+	if (Config::ORDER_BY_PHYSICAL_LOCATION && !Config::DRY_RUN) {
+		orderByPhysicalLocation(tasks);
+		if (m_cancelled) return;
+	}
+
 	// PHASE 1.5: Verify Available Space
 	uintmax_t safetyMargin = Config::DISK_SPACE_SAFETY_MARGIN;
+	// Files that will be renamed don't take any extra space.
+	uintmax_t bytesToWrite = totalBytesRequired - sameDeviceBytes;
 	try {
 		fs::space_info destSpace = fs::space(m_destDir);
 
 		// Add a safety margin to account for filesystem overhead/metadata
-		if (destSpace.available < (totalBytesRequired + safetyMargin)) {
-			double reqGB = totalBytesRequired / (1024.0 * 1024.0 * 1024.0);
+		if (destSpace.available < (bytesToWrite + safetyMargin)) {
+			double reqGB = bytesToWrite / (1024.0 * 1024.0 * 1024.0);
 			double availGB = destSpace.available / (1024.0 * 1024.0 * 1024.0);
 
 			emit errorOccurred({DiskFull,
@@ -359,6 +508,15 @@ void CopyWorker::run() {
 		return;
 	}
 
+	// Reserve the space for the whole job now, so it fails here or not at all.
+	// Falls back to the per-file check if the filesystem can't preallocate.
+	m_diskFull = false;
+	if (Config::RESERVE_JOB_SPACE && !Config::DRY_RUN && bytesToWrite > 0) {
+		if (!reserveJobSpace(bytesToWrite)) {
+			return; // DiskFull already reported
+		}
+	}
+
 	// PHASE 2: Execute Tasks
 	int totalFiles = tasks.size();
 	int processed = 0;
@@ -366,7 +524,7 @@ void CopyWorker::run() {
 	m_totalPausedDuration = std::chrono::duration<double>::zero();
 	m_totalBytesProcessed = 0;
 	m_totalSizeToCopy = totalBytesRequired;
-	m_totalWorkBytes = totalBytesRequired * (Config::CHECKSUM_ENABLED ? 2 : 1); // Copying + Optional Verifying
+	m_totalWorkBytes = totalWorkBytes;
 	// Prevent division by zero if the job consists only of empty folders (0 bytes)
 	if (m_totalWorkBytes == 0) m_totalWorkBytes = 1;
 	m_completedFilesSize = 0;
@@ -385,35 +543,132 @@ void CopyWorker::run() {
 	// Emit total files to copy
 	emit totalProgress(processed, totalFiles);
 
-	// Allocate buffer once for the entire job to avoid malloc/free overhead per file
-	// Use aligned_alloc instead of std::vector for maximum performance
-	size_t allocSize = Config::BUFFER_SIZE;
-	if (allocSize % ALIGNMENT != 0){
-		allocSize = (allocSize + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
-	}
-	
-	// Allocate memory
-	// aligned_alloc requires size to be a multiple of alignment
-	void *rawPtr = std::aligned_alloc(ALIGNMENT, allocSize);
-	if (!rawPtr) {
+	// Allocate the buffers once for the entire job to avoid malloc/free overhead per file.
+	// The engines that overlap reads and writes need the whole ring, the others just one buffer.
+	bool overlappedEngine = (Config::COPY_ENGINE == Config::CopyEngine::Auto ||
+							 Config::COPY_ENGINE == Config::CopyEngine::IoUring ||
+							 Config::COPY_ENGINE == Config::CopyEngine::Pipeline);
+	size_t ringDepth = (overlappedEngine && !Config::DRY_RUN) ? std::max(Config::IO_QUEUE_DEPTH, 2) : 1;
+
+	m_io.clear();
+	if (auto io = createIoContext(ringDepth)) {
+		m_io.push_back(std::move(io));
+	} else {
 		emit errorOccurred({SourceOpenFailed, "", "Memory allocation failed"});
+		releaseJobSpace();
 		return;
 	}
 
-	// Use unique_ptr with a custom deleter so it calls free() automatically
-	std::unique_ptr<char, decltype(&std::free)> 
-							buffer(static_cast<char *>(rawPtr), std::free);
+	// Start from the sizes earlier jobs found for the same devices
+	m_tuner.reset();
+	if (Config::BUFFER_AUTOTUNE && !Config::DRY_RUN) {
+		m_tuner = std::make_unique<BufferTuner>(m_io.front()->ring->bufferSize());
+		const QMap<QString, int> known = Config::loadTunedBufferSizes();
+		for (auto it = known.begin(); it != known.end(); ++it) {
+			// Older versions also saved anonymous device numbers, which may now be another filesystem
+			if (it.key().contains("dev:"))
+				continue;
+			m_tuner->setKnown(it.key().toStdString(), it.value());
+		}
+	}
+
+	// Checksum algorithm of this job, recorded in the history
+	m_hashAlgorithm = Hasher::isAvailable(Config::HASH_ALGORITHM) ? Config::HASH_ALGORITHM : Config::HashAlgorithm::XXH64;
+	if (Config::CHECKSUM_ENABLED) {
+		LOG(LogLevel::INFO) << "Checksum:" << Hasher::name(m_hashAlgorithm) << "(" << Hasher::implementation(m_hashAlgorithm) << ")";
+		emit jobNote(Config::HASH_TREE ? tr("Checksum: %1, hash tree root (XXH3, 1 MB blocks)").arg(Hasher::name(m_hashAlgorithm))
+									   : tr("Checksum: %1").arg(Hasher::name(m_hashAlgorithm)));
+	}
+
+	if (Config::CHECKSUM_ENABLED && Config::ASYNC_VERIFY && !Config::DRY_RUN) {
+		startVerifier(ringDepth);
+	}
+
+	// Hashes of unchanged sources from earlier jobs
+	if (Config::CHECKSUM_ENABLED) {
+		openHashCache();
+	}
+
+	// One manifest per job, so a later job into the same folder doesn't mix its files in
+	if (Config::CHECKSUM_ENABLED && Config::WRITE_HASH_MANIFEST && !Config::DRY_RUN) {
+		QString name = QString("%1_%2.%3").arg(APP_NAME, QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss"),
+											   HashManifest::extension(m_hashAlgorithm));
+		if (!m_manifest.open(fs::path(m_destDir) / name.toStdString(), m_hashAlgorithm)) {
+			emit jobNote(tr("Could not create the hash manifest"));
+		}
+	}
+
+	// Regular files are collected here and copied by the pool after the serial pass
+	// (directories, symlinks, renames and conflict prompts), largest first.
+	const bool usePool = (Config::COPY_THREADS > 1 && !Config::DRY_RUN);
+	std::vector<FileJob> fileJobs;
+	uintmax_t poolBytes = 0; // Collected for the pool, nothing of it written yet
 
 	auto lastProgressTime = std::chrono::steady_clock::now();
 
+	// Subdirectories moved by rename in Phase 2. Their entries come later in the task list
+	// (right after the directory, or at the end when ordered by physical location).
+	std::set<fs::path> renamedDirs;
+	auto insideRenamedDir = [&renamedDirs](const fs::path &path) {
+		if (renamedDirs.empty())
+			return false;
+		for (fs::path dir = path.parent_path(); dir.has_relative_path(); dir = dir.parent_path()) {
+			if (renamedDirs.count(dir))
+				return true;
+		}
+		return false;
+	};
+
 	for (auto &task : tasks) {
 		if (m_cancelled) break;
+
+		// Whole tree was already moved by rename during the scan
+		if (task.renamed) {
+			emit fileCompleted(QString::fromStdString(task.dest.string()), "", "", true, tr("Moved (rename)"));
+			processed++;
+			emit totalProgress(processed, totalFiles);
+			continue;
+		}
+
+		// Entry of a directory that was moved by rename, just count it
+		if (insideRenamedDir(task.src)) {
+			std::error_code ec;
+			if (fs::is_regular_file(fs::symlink_status(task.dest, ec))) {
+				uintmax_t size = fs::file_size(task.dest, ec);
+				if (!ec) {
+					m_totalBytesProcessed += workBytes(size);
+					m_totalBytesCopied += size;
+					m_completedFilesSize += size;
+				}
+			}
+			processed++;
+
+			auto now = std::chrono::steady_clock::now();
+			if (processed == totalFiles || std::chrono::duration_cast<std::chrono::milliseconds>(now - lastProgressTime).count() > 50) {
+				emit totalProgress(processed, totalFiles);
+				lastProgressTime = now;
+			}
+			continue;
+		}
+
 		fs::create_directories(task.dest.parent_path());
 
 		bool isSymlink = fs::is_symlink(task.src);
+		bool canRename = (task.sameDevice && m_mode == Move && !Config::DRY_RUN);
 
 		// Handle Directories
 		if (fs::is_directory(task.src) && !isSymlink) {
+			// Directory that doesn't exist at the destination yet (the parent did, so the scan
+			// couldn't rename the whole tree): move it with a single rename.
+			if (canRename && renameat2(AT_FDCWD, task.src.c_str(), AT_FDCWD, task.dest.c_str(), RENAME_NOREPLACE) == 0) {
+				renamedDirs.insert(task.src);
+				if (task.isTopLevel) {
+					emit fileCompleted(QString::fromStdString(task.dest.string()), "", "", true, tr("Moved (rename)"));
+				}
+				processed++;
+				continue;
+			}
+
 			if (!fs::exists(task.dest)) {
 				fs::create_directories(task.dest);
 			}
@@ -437,13 +692,18 @@ void CopyWorker::run() {
 		}
 
 		// Space Check (Per File)
+		// Skipped for files that will be renamed, they don't need any space,
+		// and when the space for the whole job is reserved.
+		// The files collected for the pool are not written yet, so they count as well.
 		uintmax_t currentFileSize = 0;
 		if (!isSymlink) {
 			try {
 				currentFileSize = fs::file_size(task.src);
 				// Check space (add safety margin)
-				if (fs::space(m_destDir).available < (currentFileSize + safetyMargin)) {
+				if (!canRename && m_reservationFd < 0 &&
+					fs::space(m_destDir).available < (poolBytes + currentFileSize + safetyMargin)) {
 					emit errorOccurred({DiskFull, QString::fromStdString(task.src.string())});
+					m_diskFull = true; // Also skips the files collected for the pool
 					break;
 				}
 			} catch (...) { /* Ignore space check errors, let write() fail if full */
@@ -451,6 +711,7 @@ void CopyWorker::run() {
 		}
 
 		// Existence Check & Conflict Resolution
+		bool replaceExisting = false;
 		if (fs::exists(task.dest) || fs::is_symlink(task.dest)) {
 			ConflictAction action = m_savedAction;
 
@@ -488,8 +749,10 @@ void CopyWorker::run() {
 				} catch (...) {
 				}
 
-				m_totalWorkBytes -= (fSize * (Config::CHECKSUM_ENABLED ? 2 : 1));
+				m_totalWorkBytes -= workBytes(fSize);
 				m_totalSizeToCopy -= fSize;
+				if (!canRename)
+					shrinkJobSpace(fSize);
 
 				// Throttle progress
 				auto now = std::chrono::steady_clock::now();
@@ -507,6 +770,7 @@ void CopyWorker::run() {
 				}
 			}
 			// If Replace, just proceed (O_TRUNC will handle it)
+			replaceExisting = (action == Replace);
 		}
 
 		if (isSymlink) {
@@ -577,21 +841,37 @@ void CopyWorker::run() {
 			continue;
 		}
 
-		// copyFile returns true ONLY if checksum verification succeeds
+		// Same filesystem move: a rename is enough, unless it crosses a mount point
+		if (canRename && moveFileByRename(task, currentFileSize, replaceExisting)) {
+			processed++;
+
+			auto now = std::chrono::steady_clock::now();
+			if (processed == totalFiles || std::chrono::duration_cast<std::chrono::milliseconds>(now - lastProgressTime).count() > 50) {
+				emit totalProgress(processed, totalFiles);
+				lastProgressTime = now;
+			}
+			continue;
+		}
+
+		// Copied later by the pool (with the destination chosen above)
+		if (usePool) {
+			fileJobs.push_back({task, currentFileSize});
+			poolBytes += currentFileSize;
+			continue;
+		}
+
+		// Hand this file's share of the reservation back to the filesystem
+		shrinkJobSpace(currentFileSize);
+
+		// copyFile returns false if the copy or its verification failed.
+		// Small files are verified later with their group (commitGroup).
 		bool ret_code = copyFile(task.src, 
 								task.dest, 
-								buffer.get(), 
-								allocSize, 
+								*m_io.front(), 
 								task.isTopLevel, 
 								(&task == &tasks.back()), 
 								fsType
 								);
-		if (ret_code == true) {
-			if (m_mode == Move && !Config::DRY_RUN) {
-				fs::remove(task.src);
-			}
-			m_completedFilesSize += currentFileSize;
-		}
 		processed++;
 		
 		// Throttle total progress updates (e.g. max 20 times per second)
@@ -607,6 +887,34 @@ void CopyWorker::run() {
 		if (ret_code == false && Config::DRY_RUN) {
 			break;
 		}
+
+		// Preallocation hit ENOSPC, the following files won't fit either
+		if (m_diskFull) {
+			break;
+		}
+	}
+
+	// Verify the small files still waiting for their group commit
+	commitGroup(*m_io.front(), fileJobs.empty());
+
+	if (!fileJobs.empty() && !m_cancelled && !m_diskFull) {
+		runFilePool(fileJobs, processed, totalFiles, fsType);
+	}
+
+	// Sources of verified files are removed by the verifier, so wait for it before the cleanup
+	stopVerifier();
+
+	closeHashCache();
+
+	// Every file is finalized now, nothing else is added to the manifest
+	if (m_manifest.isOpen()) {
+		QString manifestPath = QString::fromStdString(m_manifest.path().string());
+		if (m_manifest.close()) {
+			LOG(LogLevel::INFO) << "Hash manifest written:" << manifestPath;
+			emit jobNote(tr("Hash manifest: %1").arg(manifestPath));
+		} else {
+			emit jobNote(tr("Hash manifest incomplete: %1").arg(manifestPath));
+		}
 	}
 
 	// PHASE 3: Cleanup (Move Mode Only)
@@ -629,134 +937,821 @@ void CopyWorker::run() {
 		}
 	}
 
+	// Remember the buffer sizes for the next job and record them in the history
+	if (m_tuner) {
+		for (const auto &[devices, size] : m_tuner->chosenSizes(true)) {
+			Config::saveTunedBufferSize(QString::fromStdString(devices), (int)size);
+		}
+		for (const auto &[devices, size] : m_tuner->chosenSizes(false)) {
+			emit jobNote(tr("Buffer size %1 KB (%2)").arg(size / 1024).arg(QString::fromStdString(devices)));
+		}
+		m_tuner.reset();
+	}
+
+	// Release the job's buffers
+	m_io.clear();
+	releaseJobSpace();
+
 	emit finished();
 }
 
 
-// Handles the low-level copying of a single file: reading, writing, calculating hash, and syncing to disk.
-bool CopyWorker::copyFile(const fs::path &src, const fs::path &dest, char *buffer, size_t bufferSize, bool isTopLevel, bool isLastFile, FileSystemType fsType) {
-	int fd_in = -1;
-	// LOG(LogLevel::DEBUG) << "Copying file:" << src.c_str();
+// Entry of a tree listed for Compare mode, relative to the tree's root
+struct CompareEntry {
+	fs::path rel;
+	fs::file_type type;
+	uintmax_t size = 0;
+};
+
+// Lists the directories, regular files and symlinks below 'root' without following symlinks,
+// sorted by path. In that order everything inside a directory comes right after it.
+static std::vector<CompareEntry> listCompareTree(const fs::path &root, const std::atomic<bool> &cancelled) {
+	std::vector<CompareEntry> entries;
+	std::error_code ec;
+	fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec);
+	for (; !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+		if (cancelled)
+			break;
 
-	// Open the source file only if not in dry run mode
-	if (!Config::DRY_RUN) {
-		// Low-level I/O for speed and control
-		fd_in = open(src.c_str(), O_RDONLY);
+		std::error_code statusError;
+		fs::file_status status = it->symlink_status(statusError);
+		if (statusError)
+			continue;
 
-		if (fd_in < 0) {
-			emit errorOccurred({SourceOpenFailed, QString::fromStdString(src.string())});
-			return false;
+		CompareEntry entry{it->path().lexically_relative(root), status.type()};
+		if (fs::is_regular_file(status)) {
+			entry.size = it->file_size(statusError);
+			entries.push_back(std::move(entry));
+		} else if (fs::is_directory(status) || fs::is_symlink(status)) {
+			entries.push_back(std::move(entry));
 		}
+	}
+	if (ec) {
+		LOG(LogLevel::WARNING) << "Listing stopped early:" << root.c_str() << ec.message().c_str();
+	}
 
-		// Hint kernel: We will read this once, sequentially. Don't cache aggressively.
-		posix_fadvise(fd_in, 0, 0, POSIX_FADV_SEQUENTIAL | POSIX_FADV_NOREUSE);
+	std::sort(entries.begin(), entries.end(), [](const CompareEntry &a, const CompareEntry &b) {
+		return a.rel < b.rel;
+	});
+	return entries;
+}
+
+// Compare mode: lists both trees and reports what is missing, extra, of another type or size,
+// then hashes the files present on both sides with the same size and reports the ones whose
+// content differs. Nothing is written (except the hash cache of the source).
+// Identical files go to the history with both hashes, like verified copies.
+void CopyWorker::runCompare() {
+	emit statusChanged(Scanning);
+
+	fs::path srcRoot(m_sources.front());
+	fs::path destRoot(m_destDir);
+	if (!srcRoot.has_filename())
+		srcRoot = srcRoot.parent_path();
+	if (!destRoot.has_filename())
+		destRoot = destRoot.parent_path();
+
+	auto report = [this](ErrorType code, const fs::path &path, const QString &detail = QString()) {
+		emit errorOccurred({code, QString::fromStdString(path.string()), detail});
+	};
+	auto sizeDetail = [](uintmax_t srcSize, uintmax_t destSize) {
+		return tr("%1 / %2 bytes").arg(srcSize).arg(destSize);
+	};
+
+	std::vector<FileJob> jobs;
+	uintmax_t compareBytes = 0; // Both sides of every file that is hashed
+	int missing = 0;
+	int extra = 0;
+	std::atomic<int> different{0};
+
+	std::error_code ec;
+	if (!fs::exists(fs::symlink_status(srcRoot, ec))) {
+		report(SourceOpenFailed, srcRoot);
+		return;
 	}
 
-	// Open O_RDWR so we can read it back for verification without closing/reopening
-	int fd_out = open(dest.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (!fs::is_directory(fs::symlink_status(srcRoot, ec))) {
+		// A single file, compared with the file of the same name if the destination is a folder
+		fs::path destFile = fs::is_directory(destRoot, ec) ? destRoot / srcRoot.filename() : destRoot;
+		std::error_code srcError, destError;
+		uintmax_t srcSize = fs::file_size(srcRoot, srcError);
+		uintmax_t destSize = fs::file_size(destFile, destError);
+		if (srcError) {
+			report(SourceOpenFailed, srcRoot);
+			return;
+		}
+		if (!fs::exists(fs::symlink_status(destFile, ec))) {
+			report(MissingInDestination, destFile);
+			missing++;
+		} else if (destError) {
+			report(FileOpenFailed, destFile);
+		} else if (srcSize != destSize) {
+			report(SizeMismatch, destFile, sizeDetail(srcSize, destSize));
+			different++;
+		} else {
+			jobs.push_back({{srcRoot, destFile, true}, srcSize});
+			compareBytes += 2 * srcSize;
+		}
 
-	if ((!Config::DRY_RUN && fd_in < 0) || (fd_out < 0)) {
-		emit errorOccurred({FileOpenFailed, QString::fromStdString(dest.string())});
-		if (fd_in >= 0)
-			close(fd_in);
-		if (fd_out >= 0)
-			close(fd_out);
-		return false;
+	} else if (!fs::is_directory(destRoot, ec)) {
+		report(FileOpenFailed, destRoot);
+		return;
+
+	} else {
+		std::vector<CompareEntry> srcTree = listCompareTree(srcRoot, m_cancelled);
+		std::vector<CompareEntry> destTree = listCompareTree(destRoot, m_cancelled);
+		if (m_cancelled)
+			return;
+
+		// A directory that exists on one side only is reported once, not with every file in it.
+		// Its contents follow it directly in the sorted lists.
+		fs::path skipped;
+		auto inSkipped = [&skipped](const fs::path &rel) {
+			const std::string &dir = skipped.native();
+			const std::string &path = rel.native();
+			return !dir.empty() && path.size() > dir.size() && path[dir.size()] == '/' &&
+				   path.compare(0, dir.size(), dir) == 0;
+		};
+
+		// Merge the two sorted lists
+		size_t i = 0, j = 0;
+		while (i < srcTree.size() || j < destTree.size()) {
+			if (m_cancelled)
+				return;
+
+			if (j == destTree.size() || (i < srcTree.size() && srcTree[i].rel < destTree[j].rel)) {
+				const CompareEntry &entry = srcTree[i++];
+				if (inSkipped(entry.rel))
+					continue;
+				report(MissingInDestination, destRoot / entry.rel);
+				missing++;
+				if (entry.type == fs::file_type::directory)
+					skipped = entry.rel;
+
+			} else if (i == srcTree.size() || destTree[j].rel < srcTree[i].rel) {
+				const CompareEntry &entry = destTree[j++];
+				if (inSkipped(entry.rel))
+					continue;
+				report(ExtraInDestination, destRoot / entry.rel);
+				extra++;
+				if (entry.type == fs::file_type::directory)
+					skipped = entry.rel;
+
+			} else {
+				const CompareEntry &src = srcTree[i++];
+				const CompareEntry &dest = destTree[j++];
+				fs::path destPath = destRoot / dest.rel;
+
+				if (src.type != dest.type) {
+					report(ContentMismatch, destPath, tr("Not the same type"));
+					different++;
+					// The contents of the directory side exist on one side only
+					if (src.type == fs::file_type::directory || dest.type == fs::file_type::directory)
+						skipped = src.rel;
+				} else if (src.type == fs::file_type::symlink) {
+					std::error_code srcError, destError;
+					if (fs::read_symlink(srcRoot / src.rel, srcError) != fs::read_symlink(destPath, destError) ||
+						srcError || destError) {
+						report(ContentMismatch, destPath, tr("Link target differs"));
+						different++;
+					}
+				} else if (src.type == fs::file_type::regular) {
+					if (src.size != dest.size) {
+						report(SizeMismatch, destPath, sizeDetail(src.size, dest.size));
+						different++;
+					} else {
+						jobs.push_back({{srcRoot / src.rel, destPath}, src.size});
+						compareBytes += 2 * src.size;
+					}
+				}
+			}
+		}
 	}
 
-	XXH64_state_t *hashState = nullptr;
-	if (Config::CHECKSUM_ENABLED) {
-		hashState = XXH64_createState();
-		XXH64_reset(hashState, 0);
+	// PHASE 2: Hash the files that can only differ in content
+	const int totalFiles = jobs.size();
+	m_overallStartTime = std::chrono::steady_clock::now();
+	m_totalPausedDuration = std::chrono::duration<double>::zero();
+	m_totalBytesProcessed = 0;
+	m_totalSizeToCopy = compareBytes; // Bytes to read, shown as the size of the job
+	m_totalWorkBytes = std::max<uintmax_t>(compareBytes, 1);
+	m_completedFilesSize = 0;
+	m_lastSampleTime = m_overallStartTime;
+	m_lastTotalBytesProcessed = 0;
+	m_totalBytesCopied = 0;
+
+	int calculatedPoints = m_totalWorkBytes / (1024 * 1024) / 10;
+	Config::SPEED_GRAPH_HISTORY_SIZE = std::min(Config::SPEED_GRAPH_HISTORY_SIZE_USER, std::max(1, calculatedPoints));
+
+	m_hashAlgorithm = Hasher::isAvailable(Config::HASH_ALGORITHM) ? Config::HASH_ALGORITHM : Config::HashAlgorithm::XXH64;
+	LOG(LogLevel::INFO) << "Comparing" << totalFiles << "files with" << Hasher::name(m_hashAlgorithm);
+	emit jobNote(tr("Checksum: %1").arg(Hasher::name(m_hashAlgorithm)));
+	emit totalProgress(0, totalFiles);
+	emit statusChanged(Comparing);
+
+	// Unchanged sources hashed by earlier jobs aren't read again
+	openHashCache();
+
+	// Largest first, so the workers finish together
+	std::stable_sort(jobs.begin(), jobs.end(), [](const FileJob &a, const FileJob &b) {
+		return a.size > b.size;
+	});
+
+	// Two large buffers per worker, one per side: both sides of a file on different disks are
+	// read at the same time, each with long sequential reads.
+	size_t workerCount = std::clamp<size_t>(Config::COPY_THREADS, 1, std::max<size_t>(jobs.size(), 1));
+	std::vector<std::unique_ptr<BufferRing>> buffers;
+	for (size_t i = 0; i < workerCount; ++i) {
+		auto ring = std::make_unique<BufferRing>(2, Config::BUFFER_SIZE);
+		if (!ring->isValid())
+			break;
+		buffers.push_back(std::move(ring));
+	}
+	if (buffers.empty() && !jobs.empty()) {
+		emit errorOccurred({SourceOpenFailed, "", "Memory allocation failed"});
+		closeHashCache();
+		return;
 	}
+	workerCount = std::max<size_t>(buffers.size(), 1);
 
-	qint64 totalRead = 0;
-	qint64 fileSize = Config::DRY_RUN ? (Config::DRY_RUN_FILE_SIZE) : fs::file_size(src);
+	WorkStealingQueue queue(workerCount);
+	for (size_t i = 0; i < jobs.size(); ++i) {
+		queue.push(i);
+	}
 
-	emit statusChanged(Copying); // Notify UI
+	// A spinning disk reads one file at a time, like in the copy pool. Both sides of a file
+	// on one disk are read one after the other instead of seeking between them.
+	struct stat st;
+	std::vector<IoScheduler::Lane> lanes(jobs.size());
+	for (size_t i = 0; i < jobs.size(); ++i) {
+		dev_t srcDev = (stat(jobs[i].task.src.c_str(), &st) == 0) ? st.st_dev : 0;
+		dev_t destDev = (stat(jobs[i].task.dest.c_str(), &st) == 0) ? st.st_dev : 0;
+		lanes[i] = m_scheduler.lane(srcDev, destDev);
+	}
+	auto devicesFree = [&](size_t jobIndex) {
+		return m_scheduler.tryAcquire(lanes[jobIndex]);
+	};
 
-	// Read source file and write to destination
-	while (totalRead < fileSize) {
-		if (m_cancelled) break;
+	std::atomic<int> done{0};
+	std::atomic<int> identical{0};
+	auto lastProgressTime = std::chrono::steady_clock::now(); // Guarded by m_progressMutex
+
+	auto worker = [&](size_t index) {
+		BufferRing &ring = *buffers[index];
+		size_t jobIndex;
+		while (!m_cancelled) {
+			uint64_t generation = m_scheduler.generation();
+			if (!queue.pop(index, jobIndex, devicesFree)) {
+				if (queue.empty())
+					break;
+				m_scheduler.waitForRelease(generation);
+				continue;
+			}
+			const FileJob &job = jobs[jobIndex];
+			const IoScheduler::Lane &lane = lanes[jobIndex];
+
+			Hasher::Digest srcHash, destHash;
+			bool srcOk, destOk;
+			if (lane.src != lane.dest && job.size >= ring.bufferSize()) {
+				std::thread destReader([&] {
+					destOk = hashForCompare(job.task.dest, job.task.src, ring.buffer(1), ring.bufferSize(), false, destHash);
+				});
+				srcOk = hashForCompare(job.task.src, job.task.dest, ring.buffer(0), ring.bufferSize(), true, srcHash);
+				destReader.join();
+			} else {
+				srcOk = hashForCompare(job.task.src, job.task.dest, ring.buffer(0), ring.bufferSize(), true, srcHash);
+				destOk = srcOk && hashForCompare(job.task.dest, job.task.src, ring.buffer(0), ring.bufferSize(), false, destHash);
+			}
+			m_scheduler.release(lane);
+			m_completedFilesSize += job.size;
 
-		// Pause Logic
-		if (m_paused) {
-			auto pauseStart = std::chrono::steady_clock::now();
-			QMutexLocker locker(&m_sync);
-			m_pauseCond.wait(&m_sync);
+			if (m_cancelled)
+				break;
+			if (!srcOk) {
+				report(ReadError, job.task.src);
+			} else if (!destOk) {
+				report(ReadError, job.task.dest);
+			} else {
+				emit fileCompleted(QString::fromStdString(job.task.dest.string()),
+								   QString::fromStdString(srcHash.hex()), QString::fromStdString(destHash.hex()),
+								   false, "");
+				if (srcHash == destHash) {
+					identical++;
+				} else {
+					report(ContentMismatch, job.task.dest);
+					different++;
+				}
+			}
 
-			// Add the time spent paused to our offset
-			auto pauseEnd = std::chrono::steady_clock::now();
-			m_totalPausedDuration += (pauseEnd - pauseStart);
+			int count = ++done;
+			QMutexLocker locker(&m_progressMutex);
+			auto now = std::chrono::steady_clock::now();
+			if (count == totalFiles || std::chrono::duration_cast<std::chrono::milliseconds>(now - lastProgressTime).count() > 50) {
+				emit totalProgress(count, totalFiles);
+				lastProgressTime = now;
+			}
+		}
+	};
 
-			// Reset the sampling clock so the pause duration isn't
-			// counted as "active time" in the next speed calculation.
-			m_lastSampleTime = pauseEnd;
-			m_lastTotalBytesProcessed = m_totalBytesProcessed;
+	if (!jobs.empty()) {
+		std::vector<std::thread> threads;
+		threads.reserve(workerCount);
+		for (size_t i = 0; i < workerCount; ++i) {
+			threads.emplace_back(worker, i);
+		}
+		for (auto &thread : threads) {
+			thread.join();
 		}
+	}
 
-		size_t toRead = std::min((qint64)bufferSize, fileSize - totalRead);
-		ssize_t bytesRead;
+	closeHashCache();
 
-		if (Config::DRY_RUN) {
-			bytesRead = toRead; // Simulate reading from disk
-			// Simulate disk latency (roughly 10ms for a mechanical seek/read)
-			// This prevents the "instant" processing that causes GB/s spikes
-			QThread::msleep(10);
-		} else {
-			bytesRead = read(fd_in, buffer, toRead);
-		}
+	LOG(LogLevel::INFO) << "Compared" << totalFiles << "files. Identical:" << identical.load() << "Different:" << different.load()
+						<< "Missing:" << missing << "Extra:" << extra;
+	emit jobNote(tr("Compared %1 files: %2 identical, %3 different, %4 missing, %5 extra")
+					 .arg(totalFiles).arg(identical.load()).arg(different.load()).arg(missing).arg(extra));
+}
 
-		if (bytesRead < 0) {
-			emit errorOccurred({ReadError, QString::fromStdString(src.string())});
+
+// Hashes a whole file for Compare mode with long sequential reads, dropping the cached pages
+// so the data really comes from the disk. The source side ('useCache') takes its hash from
+// the hash cache when it is known, and records it there otherwise.
+// Copies use it to re-hash a source whose cached hash doesn't match the copy.
+// 'shown' is the other side of the pair, for the progress display.
+bool CopyWorker::hashForCompare(const fs::path &path, const fs::path &shown, char *buffer, size_t bufferSize,
+								bool useCache, Hasher::Digest &digest) {
+	int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+	if (fd < 0) {
+		LOG(LogLevel::ERROR) << "Cannot open:" << path.c_str() << strerror(errno);
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		close(fd);
+		return false;
+	}
+
+	if (useCache && m_hashCache && m_hashCache->lookup(fd, st, m_hashAlgorithm, digest)) {
+		m_cacheHits++;
+		m_totalBytesProcessed += st.st_size;
+		m_totalBytesCopied += st.st_size;
+		close(fd);
+		return true;
+	}
+
+	posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+	posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+	std::unique_ptr<Hasher> hasher = Hasher::create(m_hashAlgorithm);
+	qint64 fileRead = 0;
+	bool ok = true;
+	while (true) {
+		waitIfPaused();
+		if (m_cancelled) {
+			ok = false;
 			break;
 		}
-		if (bytesRead == 0) {
-			emit errorOccurred({UnexpectedEOF, QString::fromStdString(src.string())});
+		ssize_t n = read(fd, buffer, bufferSize);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n < 0) {
+			LOG(LogLevel::ERROR) << "Read error:" << path.c_str() << strerror(errno);
+			ok = false;
+			break;
+		}
+		if (n == 0)
 			break;
+		hasher->update(buffer, n);
+		fileRead += n;
+		m_totalBytesProcessed += n;
+		m_totalBytesCopied += n;
+		updateProgress(path, shown, fileRead, std::max<qint64>(st.st_size, 1));
+	}
+	posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+
+	if (ok) {
+		digest = hasher->digest();
+		// Only if nothing changed the file while it was read
+		struct stat after;
+		if (useCache && m_hashCache && fstat(fd, &after) == 0 && after.st_size == st.st_size &&
+			after.st_mtim.tv_sec == st.st_mtim.tv_sec && after.st_mtim.tv_nsec == st.st_mtim.tv_nsec &&
+			after.st_ctim.tv_sec == st.st_ctim.tv_sec && after.st_ctim.tv_nsec == st.st_ctim.tv_nsec) {
+			m_hashCache->store(fd, st, m_hashAlgorithm, digest);
 		}
+	}
+	close(fd);
+	return ok;
+}
 
-		// Calculate Hash on the fly
-		if (Config::CHECKSUM_ENABLED) {
-			XXH64_update(hashState, buffer, bytesRead);
+
+// Moves the regular files behind all directories and symlinks (so every directory still comes
+// before its contents) and sorts them by the position of their first extent on disk
+// (FS_IOC_FIEMAP). Files without a mapping (empty, inline, or a filesystem without FIEMAP)
+// are sorted by inode number, which follows the allocation order on most filesystems.
+// Reading a photo archive off a spinning disk then sweeps across it instead of seeking for
+// every file in directory order.
+void CopyWorker::orderByPhysicalLocation(std::vector<CopyTask> &tasks) {
+	struct Location {
+		dev_t device = 0;
+		bool physical = false; // Sort key is a disk offset (else an inode number)
+		uint64_t position = 0;
+
+		bool operator<(const Location &o) const {
+			return std::tie(device, physical, position) < std::tie(o.device, o.physical, o.position);
+		}
+	};
+
+	std::vector<CopyTask> others;
+	std::vector<std::pair<Location, CopyTask>> files;
+	size_t mapped = 0;
+
+	for (auto &task : tasks) {
+		if (m_cancelled)
+			return;
+
+		struct stat st;
+		if (task.renamed || lstat(task.src.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+			others.push_back(std::move(task));
+			continue;
 		}
 
-		// Write
-		ssize_t written = write(fd_out, buffer, bytesRead);
-		if (written != bytesRead) {
-			emit errorOccurred({WriteError, QString::fromStdString(src.string())});
-			break;
+		Location location;
+		location.device = st.st_dev;
+		location.position = st.st_ino;
+
+		int fd = open(task.src.c_str(), O_RDONLY);
+		if (fd >= 0) {
+			// Room for the header plus a single extent
+			alignas(struct fiemap) char request[sizeof(struct fiemap) + sizeof(struct fiemap_extent)] = {};
+			auto *map = reinterpret_cast<struct fiemap *>(request);
+			map->fm_start = 0;
+			map->fm_length = FIEMAP_MAX_OFFSET;
+			map->fm_extent_count = 1;
+
+			if (ioctl(fd, FS_IOC_FIEMAP, map) == 0 && map->fm_mapped_extents > 0 &&
+				!(map->fm_extents[0].fe_flags & (FIEMAP_EXTENT_UNKNOWN | FIEMAP_EXTENT_DATA_INLINE))) {
+				location.physical = true;
+				location.position = map->fm_extents[0].fe_physical;
+				mapped++;
+			}
+			close(fd);
 		}
+		files.emplace_back(location, std::move(task));
+	}
 
-		totalRead += bytesRead;
-		m_totalBytesProcessed += bytesRead;
-		m_unflushedBytes += bytesRead;
-		m_totalBytesCopied += bytesRead;
+	std::stable_sort(files.begin(), files.end(), [](const auto &a, const auto &b) {
+		return a.first < b.first;
+	});
 
-		// Calculate and update speed
-		updateProgress(src, dest, totalRead, fileSize);
+	tasks = std::move(others);
+	for (auto &file : files) {
+		tasks.push_back(std::move(file.second));
 	}
+	LOG(LogLevel::INFO) << "Ordered" << files.size() << "files by disk location," << mapped << "by extent.";
+}
 
-	// --- CLEANUP & CHECK PHASE ---
 
-	// If cancelled or incomplete, clean up and return
-	if (m_cancelled || totalRead != fileSize) {
-		if (Config::CHECKSUM_ENABLED)
-			XXH64_freeState(hashState);
-		if (fd_in >= 0)
-			close(fd_in);
+// Allocates the buffers of one copying thread and, for the engines that use it, its io_uring instance.
+// Returns nullptr if the buffers can't be allocated.
+std::unique_ptr<CopyWorker::IoContext> CopyWorker::createIoContext(size_t ringDepth) {
+	auto io = std::make_unique<IoContext>();
+	io->ring = std::make_unique<BufferRing>(ringDepth, Config::BUFFER_SIZE);
+	if (!io->ring->isValid())
+		return nullptr;
+
+	// Set up the io_uring engine once per job (ring, registered buffers, file table).
+	// If the kernel doesn't support it, copyFile() uses the pipeline instead.
+	if (!Config::DRY_RUN && (Config::COPY_ENGINE == Config::CopyEngine::Auto || Config::COPY_ENGINE == Config::CopyEngine::IoUring)) {
+		io->uring = std::make_unique<UringEngine>(*io->ring);
+		if (!io->uring->isReady()) {
+			io->uring.reset();
+		}
+	}
+	return io;
+}
+
+
+// Copies the regular files with COPY_THREADS workers, each with its own buffers and io_uring.
+// On trees of small files the per-file latency (open, fsync, close) dominates, and one file at
+// a time leaves the devices idle most of the time.
+// Largest files first: the long copies start right away and the small files fill the gaps at
+// the end, so the workers finish together. Conflicts were already resolved by the serial pass.
+void CopyWorker::runFilePool(std::vector<FileJob> &jobs, int &processed, int totalFiles, FileSystemType fsType) {
+	// Keep the disk order if the tasks were sorted by physical location
+	if (!Config::ORDER_BY_PHYSICAL_LOCATION) {
+		std::stable_sort(jobs.begin(), jobs.end(), [](const FileJob &a, const FileJob &b) {
+			return a.size > b.size;
+		});
+	}
+
+	// One buffer ring per worker, like the one the serial loop uses
+	size_t workerCount = std::min<size_t>(Config::COPY_THREADS, jobs.size());
+	const size_t ringDepth = m_io.front()->ring->count();
+	while (m_io.size() < workerCount) {
+		auto io = createIoContext(ringDepth);
+		if (!io) {
+			LOG(LogLevel::WARNING) << "Buffer allocation failed, copying with" << m_io.size() << "threads.";
+			break;
+		}
+		m_io.push_back(std::move(io));
+	}
+	workerCount = std::min(workerCount, m_io.size());
+
+	WorkStealingQueue queue(workerCount);
+	for (size_t i = 0; i < jobs.size(); ++i) {
+		queue.push(i);
+	}
+
+	// Devices of every file, so files sharing a spinning disk are copied one at a time
+	struct stat st;
+	dev_t destDev = (stat(m_destDir.c_str(), &st) == 0) ? st.st_dev : 0;
+	std::vector<IoScheduler::Lane> lanes(jobs.size());
+	for (size_t i = 0; i < jobs.size(); ++i) {
+		dev_t srcDev = (stat(jobs[i].task.src.c_str(), &st) == 0) ? st.st_dev : 0;
+		lanes[i] = m_scheduler.lane(srcDev, destDev);
+	}
+	auto devicesFree = [&](size_t jobIndex) {
+		return m_scheduler.tryAcquire(lanes[jobIndex]);
+	};
+
+	std::atomic<size_t> claimed{0};
+	std::atomic<int> done{processed};
+	auto lastProgressTime = std::chrono::steady_clock::now(); // Guarded by m_progressMutex
+
+	auto worker = [&](size_t index) {
+		IoContext &io = *m_io[index];
+		size_t jobIndex;
+		while (!m_cancelled && !m_diskFull) {
+			// Only files whose devices are free. If every remaining file waits for a busy
+			// disk, sleep until another worker finishes a file.
+			uint64_t generation = m_scheduler.generation();
+			if (!queue.pop(index, jobIndex, devicesFree)) {
+				if (queue.empty())
+					break;
+				m_scheduler.waitForRelease(generation);
+				continue;
+			}
+			const FileJob &job = jobs[jobIndex];
+			bool isLastFile = (++claimed == jobs.size());
+
+			// Hand this file's share of the reservation back to the filesystem
+			shrinkJobSpace(job.size);
+
+			// Source removal (Move) happens in finalizeFile once the file is verified
+			bool ret_code = copyFile(job.task.src, job.task.dest, io, job.task.isTopLevel, isLastFile, fsType);
+			m_scheduler.release(lanes[jobIndex]);
+			int count = ++done;
+
+			// Throttle total progress updates (e.g. max 20 times per second)
+			QMutexLocker locker(&m_progressMutex);
+			auto now = std::chrono::steady_clock::now();
+			if (ret_code == false || count == totalFiles ||
+				std::chrono::duration_cast<std::chrono::milliseconds>(now - lastProgressTime).count() > 50) {
+				emit totalProgress(count, totalFiles);
+				lastProgressTime = now;
+			}
+		}
+
+		// Verify the small files this thread still holds
+		commitGroup(io, false);
+	};
+
+	LOG(LogLevel::INFO) << "Copying" << jobs.size() << "files with" << workerCount << "threads.";
+
+	std::vector<std::thread> threads;
+	threads.reserve(workerCount);
+	for (size_t i = 0; i < workerCount; ++i) {
+		threads.emplace_back(worker, i);
+	}
+	for (auto &thread : threads) {
+		thread.join();
+	}
+
+	processed = done;
+	emit totalProgress(processed, totalFiles);
+}
+
+
+// Handles the low-level copying of a single file: reading, writing, calculating hash, and syncing to disk.
+bool CopyWorker::copyFile(const fs::path &src, const fs::path &dest, IoContext &io, bool isTopLevel, bool isLastFile, FileSystemType fsType) {
+	char *buffer = io.ring->buffer(0); // Used by the read/write loop and verification
+	size_t bufferSize = io.ring->bufferSize();
+	int fd_in = -1;
+	// LOG(LogLevel::DEBUG) << "Copying file:" << src.c_str();
+
+	// Open the source file only if not in dry run mode
+	if (!Config::DRY_RUN) {
+		// Low-level I/O for speed and control
+		fd_in = open(src.c_str(), O_RDONLY);
+
+		if (fd_in < 0) {
+			emit errorOccurred({SourceOpenFailed, QString::fromStdString(src.string())});
+			return false;
+		}
+
+		// Hint kernel: We will read this once, sequentially. Don't cache aggressively.
+		posix_fadvise(fd_in, 0, 0, POSIX_FADV_SEQUENTIAL | POSIX_FADV_NOREUSE);
+	}
+
+	// Open O_RDWR so we can read it back for verification without closing/reopening
+	int fd_out = open(dest.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+	if ((!Config::DRY_RUN && fd_in < 0) || (fd_out < 0)) {
+		emit errorOccurred({FileOpenFailed, QString::fromStdString(dest.string())});
+		if (fd_in >= 0)
+			close(fd_in);
+		if (fd_out >= 0)
+			close(fd_out);
+		return false;
+	}
+
+	FileTransfer ft;
+	ft.src = src;
+	ft.dest = dest;
+	ft.fd_in = fd_in;
+	ft.fd_out = fd_out;
+	ft.io = &io;
+	ft.fileSize = Config::DRY_RUN ? (Config::DRY_RUN_FILE_SIZE) : fs::file_size(src);
+
+	emit statusChanged(Copying); // Notify UI
+
+	// Same btrfs/XFS filesystem: share the extents instead of copying the data
+	if (Config::REFLINK_ENABLED && !Config::DRY_RUN && ft.fileSize > 0 && cloneFile(ft)) {
+		close(fd_in);
+		close(fd_out);
+
+		if (Config::COPY_FILE_MODIFICATION_TIME) {
+			std::error_code ec;
+			fs::last_write_time(dest, fs::last_write_time(src, ec), ec);
+		}
+
+		emit progressChanged(
+			QString::fromStdString(src.string()),
+			QString::fromStdString(dest.string()),
+			100, (int)((m_totalBytesProcessed * 100) / m_totalWorkBytes), 0, 0, 0
+		);
+		return finalizeFile({src, dest, (uintmax_t)ft.fileSize, {}, false, isTopLevel, false, tr("Cloned (reflink)")}, false, {});
+	}
+
+	// Sparse source (disk images, databases): copy only the data extents.
+	// With SPARSIFY_ZERO_RUNS every file goes through the sparse engine to drop zero blocks.
+	bool useSparse = false;
+	if (!Config::DRY_RUN && ft.fileSize > 0) {
+		struct stat srcStat;
+		bool sparseSource = (fstat(fd_in, &srcStat) == 0 && (qint64)srcStat.st_blocks * 512 < ft.fileSize);
+		useSparse = (Config::SPARSE_FILES_ENABLED && sparseSource) || Config::SPARSIFY_ZERO_RUNS;
+	}
+
+	// Allocate the whole file up front: contiguous extents instead of growing it one write at
+	// a time, and a full disk shows up here instead of in the middle of the file.
+	// FALLOC_FL_KEEP_SIZE leaves the size at 0, so a partial file never looks complete.
+	// Not for sparse copies, it would fill the holes.
+	if (Config::PREALLOCATE_ENABLED && !Config::DRY_RUN && ft.fileSize > 0 && !useSparse) {
+		if (fallocate(fd_out, FALLOC_FL_KEEP_SIZE, 0, ft.fileSize) != 0) {
+			if (errno == ENOSPC || errno == EDQUOT) {
+				emit errorOccurred({DiskFull, QString::fromStdString(src.string())});
+				m_diskFull = true;
+				close(fd_in);
+				close(fd_out);
+				std::error_code ec;
+				fs::remove(dest, ec);
+				return false;
+			}
+			// EOPNOTSUPP: FAT32, NTFS-3G, some FUSE filesystems. Just write normally.
+		}
+	}
+
+	// Source hashed by an earlier job and unchanged since: no need to hash it again, and without
+	// hashing Auto can use copy_file_range. The destination is still verified in full against it,
+	// but without block hashes a damaged copy can't be repaired block by block.
+	struct stat srcStat = {};
+	Hasher::Digest cachedHash;
+	bool cacheHit = false;
+	if (m_hashCache && fstat(fd_in, &srcStat) == 0) {
+		bool needBlocks = useSampling(ft.fileSize) || Config::HASH_TREE;
+		cacheHit = !needBlocks && m_hashCache->lookup(fd_in, srcStat, m_hashAlgorithm, cachedHash);
+		if (cacheHit) {
+			LOG(LogLevel::DEBUG) << "Source hash from the cache:" << src.c_str();
+			m_cacheHits++;
+		}
+	}
+
+	if (Config::CHECKSUM_ENABLED && !cacheHit) {
+		// Per-block hashes for sampling, the hash tree and repairing damaged blocks
+		ft.hasher = std::make_unique<ChunkHasher>(m_hashAlgorithm, useSampling(ft.fileSize) || Config::HASH_TREE || Config::REPAIR_ENABLED);
+	}
+
+	// Devices of this file, for the choice of engine and the buffer size autotuner
+	struct stat inStat, outStat;
+	bool haveDevices = !Config::DRY_RUN && fstat(fd_in, &inStat) == 0 && fstat(fd_out, &outStat) == 0;
+	std::string devicePair;
+	IoScheduler::Lane lane;
+	if (haveDevices && m_tuner) {
+		lane = m_scheduler.lane(inStat.st_dev, outStat.st_dev);
+		devicePair = m_scheduler.pairName(lane);
+		io.ring->setChunkSize(m_tuner->chunkSize(devicePair, m_scheduler.hasStableName(lane)));
+	} else {
+		io.ring->setChunkSize(io.ring->bufferSize());
+	}
+	bufferSize = io.ring->chunkSize();
+
+	// Without hashing there is no reason to pull the data into user space at all
+	bool useCopyRange = !Config::DRY_RUN &&
+						(Config::COPY_ENGINE == Config::CopyEngine::CopyFileRange ||
+						 (Config::COPY_ENGINE == Config::CopyEngine::Auto && !ft.hasher));
+
+	// Files that fit in a single buffer gain nothing from overlapping reads and writes
+	bool overlapped = !Config::DRY_RUN && ft.fileSize > (qint64)bufferSize && io.ring->count() > 1;
+
+	// Large files bypass the page cache, so gigabytes of dirty pages don't pile up
+	// (and stall the sync at the end of the file) or evict other programs' cache.
+	// Not used with copy_file_range, which never touches our buffers.
+	if (Config::DIRECT_WRITE_ENABLED && !Config::DRY_RUN && !useCopyRange &&
+		ft.fileSize >= (qint64)Config::DIRECT_WRITE_THRESHOLD_MB * 1024 * 1024) {
+		int flags = fcntl(fd_out, F_GETFL);
+		ft.directWrite = (fcntl(fd_out, F_SETFL, flags | O_DIRECT) == 0); // EINVAL on e.g. tmpfs
+	}
+
+	// Very large files: several threads copy independent ranges to reach a high queue depth
+	// Not on spinning disks, where the interleaved ranges would only add seeks.
+	bool useParallel = overlapped && haveDevices && Config::PARALLEL_COPY_THREADS > 1 &&
+					   ft.fileSize >= (qint64)Config::PARALLEL_COPY_THRESHOLD_MB * 1024 * 1024 &&
+					   !m_scheduler.isRotational(inStat.st_dev) && !m_scheduler.isRotational(outStat.st_dev);
+
+	// Source and destination on one spinning disk: alternating reads and writes of one buffer
+	// each make the heads seek for every chunk, so move the data in large windows instead.
+	bool useWindow = haveDevices && Config::HDD_WINDOW_MB > 0 && ft.fileSize > (qint64)bufferSize &&
+					 m_scheduler.sameRotationalDisk(inStat.st_dev, outStat.st_dev);
+
+	// mmap: hash and write straight from the page cache, skipping the copy into our buffer.
+	// Auto only picks it for local sources that are mostly cached already (checked in copyWithMmap),
+	// a cold source is read faster with read() and readahead.
+	bool autoMmap = (Config::COPY_ENGINE == Config::CopyEngine::Auto && ft.fileSize > (qint64)bufferSize && !ft.directWrite);
+	bool useMmap = !Config::DRY_RUN && ft.fileSize > 0 &&
+				   (Config::COPY_ENGINE == Config::CopyEngine::Mmap || autoMmap);
+
+	// Read source file and write to destination.
+	// copy_file_range falls back here when the kernel can't offload this pair of files;
+	// the engines below then continue from the current file offsets.
+	auto copyStart = std::chrono::steady_clock::now();
+	auto pausedAtStart = pausedTime();
+	uint64_t laneStamp = devicePair.empty() ? 0 : m_scheduler.soleUseStamp(lane);
+
+	if (useSparse && copyWithSparse(ft, buffer, bufferSize)) {
+		// Done extent by extent
+	} else if (useWindow && copyWithWindow(ft)) {
+		// Done window by window
+	} else if (useCopyRange && copyWithCopyFileRange(ft, buffer, bufferSize)) {
+		// Done in the kernel
+	} else if (useParallel && ft.totalRead == 0) {
+		copyWithParallelChunks(ft);
+	} else if (useMmap && ft.totalRead == 0 && copyWithMmap(ft, bufferSize, autoMmap)) {
+		// Done from the mapping
+	} else if (overlapped && ft.totalRead == 0 && io.uring && io.uring->isReady()) {
+		copyWithUring(ft);
+	} else if (overlapped && Config::COPY_ENGINE != Config::CopyEngine::ReadWrite) {
+		copyWithPipeline(ft);
+	} else {
+		copyWithReadWrite(ft, buffer, bufferSize);
+	}
+
+	// Tell the autotuner how fast this chunk size was. Only a copy that had its devices to
+	// itself measures the chunk size rather than the other workers, and paused time doesn't count.
+	if (!devicePair.empty() && !m_cancelled && ft.totalRead == ft.fileSize &&
+		(uint64_t)ft.fileSize >= BufferTuner::minSampleFileSize(bufferSize) &&
+		laneStamp != 0 && m_scheduler.soleUseStamp(lane) == laneStamp) {
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - copyStart - (pausedTime() - pausedAtStart);
+		m_tuner->addSample(devicePair, bufferSize, ft.fileSize, elapsed.count());
+	}
+
+	// Set the final size: the O_DIRECT tail was written padded to ALIGNMENT,
+	// or the file ends in a hole that was never written
+	bool truncateFailed = false;
+	if (ft.needsTruncate && ftruncate(fd_out, ft.fileSize) != 0) {
+		emit errorOccurred({WriteError, QString::fromStdString(src.string())});
+		truncateFailed = true;
+	}
+	if (ft.directWrite) {
+		fcntl(fd_out, F_SETFL, fcntl(fd_out, F_GETFL) & ~O_DIRECT);
+	}
+
+	// --- CLEANUP & CHECK PHASE ---
+
+	// If cancelled or incomplete, clean up and return
+	if (m_cancelled || ft.totalRead != ft.fileSize || truncateFailed) {
+		if (fd_in >= 0)
+			close(fd_in);
 		if (fd_out >= 0)
 			close(fd_out);
 
 		// Delete the partial file
 		LOG(LogLevel::INFO) << "Removing partial file:" << QString::fromStdString(dest.string());
 		LOG(LogLevel::INFO) << "Reason: cancelled =" << m_cancelled
-								<< ", fileSize =" << fileSize << ", totalRead =" << totalRead;
+								<< ", fileSize =" << ft.fileSize << ", totalRead =" << ft.totalRead;
 		try {
 			fs::remove(dest);
 		} catch (...) {
 		}
-		m_totalBytesCopied -= totalRead;
+		m_totalBytesCopied -= ft.totalRead;
 		return false;
 	}
 
@@ -773,9 +1768,10 @@ bool CopyWorker::copyFile(const fs::path &src, const fs::path &dest, char *buffe
 	);
 
 	// Grouped Syncing Logic
-	// Only sync if the file is large (per user definition) or 
-	// we have accumulated enough bytes or this is the last file.
-	bool shouldSync = (fileSize >= Config::SYNC_THRESHOLD_MB) || (m_unflushedBytes >= 64 * 1024 * 1024) || isLastFile;
+	// Only large files (per user definition) are synced and verified on their own.
+	// Smaller ones join the group of this thread and are synced together (see commitGroup).
+	bool shouldSync = (ft.fileSize >= (qint64)Config::SYNC_THRESHOLD_MB * 1024 * 1024);
+	bool deferVerify = !shouldSync && !Config::DRY_RUN && (Config::CHECKSUM_ENABLED || m_mode == Move);
 	bool useSyncFileRange = (fsType == FileSystemType::EXT); // Only for EXT and XFS
 
 	// Start flushing to disk asynchronously while we calculate the hash
@@ -786,12 +1782,21 @@ bool CopyWorker::copyFile(const fs::path &src, const fs::path &dest, char *buffe
 
 	// If we are here, the copy phase finished successfully.
 	// Calculate Source Hash
-	uint64_t srcHash = 0;
-	if (Config::CHECKSUM_ENABLED) {
+	Hasher::Digest srcHash;
+	std::vector<uint64_t> blockHashes;
+	if (ft.hasher) {
 		LOG(LogLevel::DEBUG) << "Generating Source Hash...";
 		emit statusChanged(GeneratingHash);
-		srcHash = XXH64_digest(hashState);
-		XXH64_freeState(hashState);
+		srcHash = ft.hasher->digest();
+		blockHashes = ft.hasher->takeBlockHashes();
+	} else if (cacheHit) {
+		srcHash = cachedHash;
+	}
+	bool sampled = useSampling(ft.fileSize) && !blockHashes.empty();
+	bool hashTree = Config::HASH_TREE && !blockHashes.empty() && !sampled;
+	Hasher::Digest fileHash = srcHash;
+	if (hashTree) {
+		srcHash = Hasher::Digest::fromUint64(ChunkHasher::rootOf(blockHashes));
 	}
 
 	if (fd_in >= 0)	close(fd_in);
@@ -822,154 +1827,1709 @@ bool CopyWorker::copyFile(const fs::path &src, const fs::path &dest, char *buffe
 		fs::last_write_time(dest, fs::last_write_time(src, ec), ec);
 	}
 
-	// Only drop cache if we actually synced (meaning we hit the threshold)
-	if (Config::CHECKSUM_ENABLED && shouldSync) {
-		// Tell the OS: "I'm done with this, throw it out of RAM."
-		posix_fadvise(fd_out, 0, 0, POSIX_FADV_DONTNEED);
+	PendingFile file{src, dest, (uintmax_t)ft.fileSize, srcHash, Config::CHECKSUM_ENABLED, isTopLevel, false, QString(), std::move(blockHashes), hashTree, sampled, fileHash};
+	// Read the copy back while the next file is copied, unless the destination is a spinning disk:
+	// reading file N back while N+1 is written to the same platters makes both seek on every chunk
+	file.background = m_verifyThread.joinable() && !(haveDevices && m_scheduler.isRotational(outStat.st_dev));
+	// Not worth it for a source that is removed after the copy
+	file.cacheSource = m_hashCache && ft.hasher && m_mode != Move;
+	file.srcHashCached = cacheHit;
+	file.srcStat = srcStat;
+
+	if (deferVerify) {
+		close(fd_out);
+		io.pending.push_back(std::move(file));
+		io.pendingBytes += ft.fileSize;
+
+		if (io.pending.size() >= (size_t)std::max(Config::VERIFY_GROUP_FILES, 1) ||
+			io.pendingBytes >= (uintmax_t)Config::VERIFY_GROUP_MB * 1024 * 1024) {
+			commitGroup(io, false);
+		}
+		return true;
 	}
 
 	// Verify Phase (Read from disk)
-	uint64_t diskHash = 0;
+	// Only if we actually synced (meaning we hit the threshold)
+	if (file.hashed && shouldSync && file.background) {
+		close(fd_out);
+		queueVerification(std::move(file));
+		return true;
+	}
+
+	bool ok = (file.hashed && shouldSync) ? verifyAndFinalize(file, fd_out, io, isLastFile) : finalizeFile(file, false, {});
+	close(fd_out);
+	return ok;
+}
+
+
+// Reads a synced file back from the disk and finalizes it with the result.
+// A destination that doesn't match the source hash is removed.
+bool CopyWorker::verifyAndFinalize(const PendingFile &file, int fd, IoContext &io, bool isLastFile) {
+	// Tell the OS: "I'm done with this, throw it out of RAM."
+	posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+
+	Hasher::Digest diskHash;
 	bool checksumFailed = false;
+	QString detail;
+	std::vector<uint64_t> badBlocks;
+	bool verified;
+	if (file.hashTree) {
+		verified = verifyTree(file, fd, io, isLastFile, diskHash, badBlocks, detail);
+	} else if (file.sampled) {
+		verified = verifySample(file, fd, io, isLastFile);
+	} else {
+		verified = verifyFile(file.src, file.dest, fd, file.srcHash, diskHash, io, isLastFile, file.background);
+	}
 
-	if (Config::CHECKSUM_ENABLED && shouldSync) {
-		if (!verifyFile(src, dest, fd_out, srcHash, diskHash, buffer, bufferSize, isLastFile)) {
-			LOG(LogLevel::ERROR) << "Verification failed:" << dest.c_str();
-			// Verification failed or was cancelled during verification
-			try {
-				LOG(LogLevel::INFO) << "Removing failed checksum destination file:" << dest.c_str();
-				fs::remove(dest);
-			} catch (...) {	}
-			m_totalBytesCopied -= totalRead;
-			checksumFailed = true;
+	// Rewrite only the damaged blocks instead of throwing the whole copy away
+	if (!verified && !m_cancelled && Config::REPAIR_ENABLED && !file.blockHashes.empty()) {
+		uint64_t repaired = 0;
+		if (repairFile(file, fd, io, badBlocks, repaired)) {
+			// The block checks don't cover the file length, so read the whole copy again and
+			// compare it with the whole-file hash of the source. This pass replaces the share of
+			// the progress the first verification already counted.
+			m_totalBytesProcessed -= file.size;
+			Hasher::Digest repairedHash;
+			verified = verifyFile(file.src, file.dest, fd, file.fileHash, repairedHash, io, isLastFile, file.background);
+			// A tree file lists the tree root of the source, which a whole-file hash can't be compared with
+			diskHash = file.hashTree ? Hasher::Digest() : repairedHash;
+			if (verified)
+				detail = tr("Repaired %1 damaged blocks").arg(repaired);
 		}
 	}
 
-	close(fd_out);
-
-	// Emit completion signal with hashes
-	emit fileCompleted(
-		QString::fromStdString(dest.string()),
-		Config::CHECKSUM_ENABLED ? QString::number(srcHash, 16) : "",
-		Config::CHECKSUM_ENABLED ? QString::number(diskHash, 16) : "",
-		isTopLevel
-	);
+	// A cached source hash may be stale: rewriting a file in place and putting its mtime back
+	// (cp -p onto it, touch -r) keeps the old entry valid. Hash the source now before the copy fails.
+	if (!verified && !m_cancelled && file.srcHashCached) {
+		LOG(LogLevel::WARNING) << "Copy doesn't match the cached source hash, hashing the source:" << file.src.c_str();
+		// Replaces the share of the progress the verification already counted
+		m_totalBytesProcessed -= file.size;
+		Hasher::Digest srcHash;
+		if (hashForCompare(file.src, file.dest, io.ring->buffer(0), io.ring->chunkSize(), false, srcHash) && srcHash == diskHash) {
+			PendingFile rehashed = file;
+			rehashed.srcHash = srcHash;
+			rehashed.fileHash = srcHash;
+			rehashed.cacheSource = (m_mode != Move); // Replaces the stale entry
+			return finalizeFile(rehashed, false, diskHash);
+		}
+	}
 
-	if (checksumFailed){
-		emit errorOccurred({ChecksumMismatch, QString::fromStdString(dest.string())});
+	if (!verified) {
+		LOG(LogLevel::ERROR) << "Verification failed:" << file.dest.c_str();
+		// Verification failed or was cancelled during verification
+		try {
+			LOG(LogLevel::INFO) << "Removing failed checksum destination file:" << file.dest.c_str();
+			fs::remove(file.dest);
+		} catch (...) {	}
+		checksumFailed = true;
 	}
 
-	return true;
+	return finalizeFile(file, checksumFailed, diskHash, detail);
 }
 
 
-// Verifies the integrity of the copied file by reading it back from disk and comparing checksums.
-bool CopyWorker::verifyFile(
-	const std::filesystem::path &src,
-	const std::filesystem::path &dest,
-	int fd_dest,
-	uint64_t expectedHash,
-	uint64_t &outDiskHash,
-	char *buffer,
-	size_t bufferSize,
-	bool isLastFile) 
-{
-	// uintmax_t syncThreshold = static_cast<uintmax_t>(Config::SYNC_THRESHOLD_MB) * 1024 * 1024;
-	emit statusChanged(Verifying); // Update UI status
-	// LOG(LogLevel::DEBUG) << "Verifying file:" << src.c_str();
+// Syncs the small files collected by copyFile with one syncfs() per filesystem,
+// then verifies each of them from the disk and finalizes it.
+// Replaces an fdatasync() per file, which is what makes copying many small files slow.
+void CopyWorker::commitGroup(IoContext &io, bool isLastGroup) {
+	if (io.pending.empty())
+		return;
 
-	// Hybrid Strategy for Verification:
-	// Small files: Standard buffered read (fast, reads from Cache if we skipped fdatasync).
-	// Large files: O_DIRECT (safe, reads from Disk, requires fdatasync to have happened).
-	bool useDirect = false;
-	qint64 fileSize = fs::file_size(dest);
+	std::vector<PendingFile> group;
+	group.swap(io.pending);
+	io.pendingBytes = 0;
 
-	// Optimization: Skip O_DIRECT entirely for files smaller than alignment
-	if (fileSize >= ALIGNMENT) {
-	// if (fileSize >= syncThreshold && fileSize >= ALIGNMENT) {
-		useDirect = true;
+	// Cancelled: keep the copies, but don't verify them or remove their sources
+	if (m_cancelled) {
+		for (const auto &file : group) {
+			emit fileCompleted(QString::fromStdString(file.dest.string()),
+							   file.hashed ? QString::fromStdString(file.srcHash.hex()) : "", "",
+							   file.isTopLevel, tr("Not verified (cancelled)"));
+		}
+		return;
 	}
 
-	// Reuse the existing file descriptor
-	int fd = fd_dest;
-	lseek(fd, 0, SEEK_SET);
+	std::vector<int> fds(group.size(), -1);
+	std::vector<dev_t> synced;
 
-	// Try to enable O_DIRECT on the existing FD if requested
-	int originalFlags = fcntl(fd, F_GETFL);
-	if (useDirect) {
-		if (fcntl(fd, F_SETFL, originalFlags | O_DIRECT) < 0) {
-			useDirect = false; // Fallback to buffered if O_DIRECT fails
+	for (size_t i = 0; i < group.size(); ++i) {
+		fds[i] = open(group[i].dest.c_str(), O_RDONLY);
+		if (fds[i] < 0) {
+			LOG(LogLevel::ERROR) << "Failed to reopen for verification:" << group[i].dest.c_str() << strerror(errno);
+			continue;
+		}
+
+		// One syncfs() per destination filesystem writes the data and metadata of the whole group
+		struct stat st;
+		if (fstat(fds[i], &st) != 0) {
+			// Filesystem unknown: sync this file on its own
+			fdatasync(fds[i]);
+		} else if (std::find(synced.begin(), synced.end(), st.st_dev) == synced.end()) {
+			if (syncfs(fds[i]) != 0) {
+				LOG(LogLevel::WARNING) << "syncfs failed:" << strerror(errno) << "- syncing file by file.";
+				fdatasync(fds[i]);
+			} else {
+				synced.push_back(st.st_dev);
+			}
 		}
 	}
-	
-	if (!useDirect) {
-		// Hint sequential access for buffered reads
-		// If O_DIRECT failed, we try to clear the cache so we read from disk
-		// POSIX_FADV_DONTNEED in the fallback path: This attempts to clear the cache
-		// before reading, maximizing the chance of a physical disk read even without O_DIRECT.
-		posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
-		posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+	m_unflushedBytes = 0;
+
+	LOG(LogLevel::DEBUG) << "Group commit:" << group.size() << "files," << synced.size() << "syncfs call(s)";
+
+	for (size_t i = 0; i < group.size(); ++i) {
+		PendingFile &file = group[i];
+
+		if (fds[i] < 0) {
+			// Nothing was confirmed on the disk: counts as a failed verification, the source is kept
+			m_totalBytesCopied -= file.size;
+			emit errorOccurred({FileOpenFailed, QString::fromStdString(file.dest.string()), tr("Could not be reopened for verification")});
+		} else if (file.hashed && file.background) {
+			close(fds[i]);
+			queueVerification(std::move(file));
+		} else {
+			bool isLast = isLastGroup && (i + 1 == group.size());
+			if (file.hashed) {
+				verifyAndFinalize(file, fds[i], io, isLast);
+			} else {
+				finalizeFile(file, false, {});
+			}
+			close(fds[i]);
+		}
 	}
+}
 
-	XXH64_state_t *state = XXH64_createState();
-	XXH64_reset(state, 0);
 
-	qint64 totalRead = 0;
+// Starts the verifier thread with its own buffers, so reading a finished file back
+// doesn't wait for (or take the buffers of) the copy of the next one.
+void CopyWorker::startVerifier(size_t ringDepth) {
+	m_verifyClosed = false;
+	m_verifyQueue.clear();
 
-	while (totalRead < fileSize) {
-		if (m_cancelled)
-			break;
+	m_verifyIo = createIoContext(ringDepth);
+	if (!m_verifyIo) {
+		LOG(LogLevel::WARNING) << "Buffer allocation failed, verifying in the copy thread.";
+		return;
+	}
+	m_verifyThread = std::thread(&CopyWorker::verifierLoop, this);
+}
 
-		// Pause Logic
-		if (m_paused) {
-			auto pauseStart = std::chrono::steady_clock::now();
-			QMutexLocker locker(&m_sync);
-			m_pauseCond.wait(&m_sync);
 
-			// Add the time spent paused to our offset
-			auto pauseEnd = std::chrono::steady_clock::now();
-			m_totalPausedDuration += (pauseEnd - pauseStart);
+// Hands a synced file to the verifier thread.
+void CopyWorker::queueVerification(PendingFile file) {
+	QMutexLocker locker(&m_verifyMutex);
+	m_verifyQueue.push_back(std::move(file));
+	m_verifyCond.wakeOne();
+}
 
-			// Reset the sampling clock so the pause duration isn't
-			// counted as "active time" in the next speed calculation.
-			m_lastSampleTime = pauseEnd;
-			m_lastTotalBytesProcessed = m_totalBytesProcessed;
+
+// Waits until the verifier has checked every queued file, then frees its buffers.
+void CopyWorker::stopVerifier() {
+	if (!m_verifyThread.joinable())
+		return;
+
+	{
+		QMutexLocker locker(&m_verifyMutex);
+		if (!m_verifyQueue.empty()) {
+			emit statusChanged(Verifying);
 		}
+		m_verifyClosed = true;
+		m_verifyCond.wakeAll();
+	}
+	m_verifyThread.join();
+	m_verifyIo.reset();
+}
 
-		qint64 remaining = fileSize - totalRead;
-		size_t toRead = std::min((qint64)bufferSize, remaining);
 
-		// O_DIRECT handling: Read size must be aligned.
-		// If we are at the tail and it's not aligned, drop O_DIRECT.
-		if (useDirect && (toRead % ALIGNMENT != 0)) {
-			int currentFlags = fcntl(fd, F_GETFL);
-			fcntl(fd, F_SETFL, currentFlags & ~O_DIRECT);
-			useDirect = false; // Stays off for the remainder (which is just this last chunk)
+// Verifier thread: verifies and finalizes the queued files in the order they were copied.
+void CopyWorker::verifierLoop() {
+	while (true) {
+		PendingFile file;
+		bool isLastFile = false;
+		{
+			QMutexLocker locker(&m_verifyMutex);
+			while (m_verifyQueue.empty() && !m_verifyClosed) {
+				m_verifyCond.wait(&m_verifyMutex);
+			}
+			if (m_verifyQueue.empty())
+				break;
+
+			file = std::move(m_verifyQueue.front());
+			m_verifyQueue.pop_front();
+			// The copy is over and this is the last file of the job
+			isLastFile = m_verifyClosed && m_verifyQueue.empty();
 		}
 
-		ssize_t n = read(fd, buffer, toRead);
-		if (n <= 0)	break;
+		// Cancelled: keep the copies, but don't verify them or remove their sources
+		if (m_cancelled) {
+			emit fileCompleted(QString::fromStdString(file.dest.string()),
+							   QString::fromStdString(file.srcHash.hex()), "",
+							   file.isTopLevel, tr("Not verified (cancelled)"));
+			continue;
+		}
 
-		XXH64_update(state, buffer, n);
-		totalRead += n;
-		m_totalBytesProcessed += n;
-		updateProgress(src, dest, totalRead, fileSize);
+		int fd = open(file.dest.c_str(), O_RDONLY);
+		if (fd < 0) {
+			LOG(LogLevel::ERROR) << "Failed to reopen for verification:" << file.dest.c_str() << strerror(errno);
+			finalizeFile(file, true, {});
+			continue;
+		}
+		verifyAndFinalize(file, fd, *m_verifyIo, isLastFile);
+		close(fd);
 	}
+}
 
-	// Force 100% and reset speed graph after verification
-	int totalPercent = (int)((m_totalBytesProcessed * 100) / m_totalWorkBytes);
 
-	if (isLastFile)
-		totalPercent = 100;
+// Last step of every file once it is on the disk (and verified, if enabled):
+// reports it and, in Move mode, removes the source. A source is never removed
+// for a destination that failed verification.
+// Returns false if the verification failed. 'detail' is added to the error (damaged ranges),
+// or replaces the note of a verified file (repaired blocks).
+bool CopyWorker::finalizeFile(const PendingFile &file, bool checksumFailed, const Hasher::Digest &diskHash, const QString &detail) {
+	if (checksumFailed) {
+		m_totalBytesCopied -= file.size;
+	} else {
+		if (m_mode == Move && !Config::DRY_RUN) {
+			std::error_code ec;
+			fs::remove(file.src, ec);
+			if (ec) {
+				LOG(LogLevel::WARNING) << "Failed to remove source:" << file.src.c_str() << ec.message();
+			}
+		}
+		m_completedFilesSize += file.size;
 
-	emit progressChanged(
-		QString::fromStdString(src.string()),
-		QString::fromStdString(dest.string()),
-		100, totalPercent, 0, 0, 0
+		// Only verified copies are listed, with the hash of the source
+		if (file.hashed && m_manifest.isOpen()) {
+			m_manifest.add(file.dest.lexically_relative(m_destDir), file.fileHash);
+		}
+		if (file.hashed && file.cacheSource) {
+			cacheSourceHash(file);
+		}
+	}
+
+	// Sampled files have no hash of the whole destination
+	bool sampled = file.sampled;
+	QString note = file.note;
+	if (sampled) {
+		note = tr("Sampled %1 of %2 blocks").arg(sampledBlocks(file.size)).arg(file.blockHashes.size());
+	}
+	if (!checksumFailed && !detail.isEmpty()) {
+		note = detail;
+	}
+
+	// Emit completion signal with hashes
+	emit fileCompleted(
+		QString::fromStdString(file.dest.string()),
+		file.hashed ? QString::fromStdString(file.srcHash.hex()) : "",
+		(file.hashed && !sampled) ? QString::fromStdString(diskHash.hex()) : "",
+		file.isTopLevel,
+		note
 	);
 
-	outDiskHash = XXH64_digest(state);
-	XXH64_freeState(state);
+	if (checksumFailed) {
+		emit errorOccurred({ChecksumMismatch, QString::fromStdString(file.dest.string()), detail});
+	}
+
+	return !checksumFailed;
+}
+
+
+// Creates the hash cache of this job (HASH_CACHE) with the index in the app data folder
+void CopyWorker::openHashCache() {
+	m_hashCache.reset();
+	m_cacheHits = 0;
+	if (!Config::HASH_CACHE || Config::DRY_RUN)
+		return;
+
+	m_hashCache = std::make_unique<HashCache>();
+	QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+	if (!dataDir.isEmpty() && QDir().mkpath(dataDir)) {
+		m_hashCache->openIndex((dataDir + "/hashcache.idx").toStdString());
+	}
+}
+
+// Records how many files the hash cache saved from being read and closes it
+void CopyWorker::closeHashCache() {
+	if (!m_hashCache)
+		return;
+
+	LOG(LogLevel::INFO) << "Hash cache hits:" << m_cacheHits.load();
+	if (m_cacheHits > 0) {
+		emit jobNote(tr("Checksums of %1 unchanged files taken from the hash cache").arg(m_cacheHits.load()));
+	}
+	m_hashCache.reset();
+}
+
+
+// Records the hash of a verified copy's source in the hash cache, so the next job copying it
+// doesn't read it just to hash it. Skipped if the source changed since it was read.
+void CopyWorker::cacheSourceHash(const PendingFile &file) {
+	int fd = open(file.src.c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+	if (fd < 0)
+		return;
+
+	const struct stat &before = file.srcStat;
+	struct stat st;
+	if (fstat(fd, &st) == 0 && st.st_dev == before.st_dev && st.st_ino == before.st_ino &&
+		st.st_size == before.st_size &&
+		st.st_mtim.tv_sec == before.st_mtim.tv_sec && st.st_mtim.tv_nsec == before.st_mtim.tv_nsec &&
+		st.st_ctim.tv_sec == before.st_ctim.tv_sec && st.st_ctim.tv_nsec == before.st_ctim.tv_nsec) {
+		m_hashCache->store(fd, before, m_hashAlgorithm, file.fileHash);
+	}
+	close(fd);
+}
+
+
+// Clones the whole source into the destination with FICLONE (btrfs, XFS with reflink=1, bcachefs).
+// Returns false if the filesystem can't clone this pair, the caller then copies normally.
+// The clone shares the source extents, so the data can't differ and there is nothing to verify.
+bool CopyWorker::cloneFile(FileTransfer &ft) {
+	if (ioctl(ft.fd_out, FICLONE, ft.fd_in) != 0) {
+		// EXDEV: different filesystems, EOPNOTSUPP/EINVAL: no reflink support
+		if (errno != EXDEV && errno != EOPNOTSUPP && errno != EINVAL && errno != ENOTTY) {
+			LOG(LogLevel::WARNING) << "FICLONE failed:" << strerror(errno) << "-" << ft.src.c_str();
+		}
+		return false;
+	}
+
+	// The clone is a metadata operation. Commit it before the source is removed.
+	if (m_mode == Move) {
+		fsync(ft.fd_out);
+	}
+
+	ft.totalRead = ft.fileSize;
+	m_totalBytesCopied += ft.fileSize;
+	// Count the skipped verification pass as done too, so the total progress stays correct
+	m_totalBytesProcessed += workBytes(ft.fileSize);
+	return true;
+}
+
+
+// Moves a file within the same filesystem with renameat2().
+// Without 'replace' an existing destination is never overwritten (RENAME_NOREPLACE).
+// Returns false if the caller has to copy the file instead (EXDEV across bind mounts, etc.).
+bool CopyWorker::moveFileByRename(const CopyTask &task, uintmax_t fileSize, bool replace) {
+	unsigned int flags = replace ? 0 : RENAME_NOREPLACE;
+	if (renameat2(AT_FDCWD, task.src.c_str(), AT_FDCWD, task.dest.c_str(), flags) != 0) {
+		LOG(LogLevel::DEBUG) << "Rename failed (" << strerror(errno) << "), copying:" << task.src.c_str();
+		return false;
+	}
+
+	// Nothing to copy or verify, count the file as done
+	m_totalBytesProcessed += workBytes(fileSize);
+	m_totalBytesCopied += fileSize;
+	m_completedFilesSize += fileSize;
+
+	emit progressChanged(
+		QString::fromStdString(task.src.string()),
+		QString::fromStdString(task.dest.string()),
+		100, (int)((m_totalBytesProcessed * 100) / m_totalWorkBytes), 0, 0, 0
+	);
+	emit fileCompleted(QString::fromStdString(task.dest.string()), "", "", task.isTopLevel, tr("Moved (rename)"));
+	return true;
+}
+
+
+// Creates a hidden file in the destination and allocates 'bytes' for it, so the space for
+// the whole job is taken before the first file is copied. Returns false (and reports DiskFull)
+// if the space is not available. If the filesystem can't preallocate, the reservation is
+// skipped and run() falls back to the per-file space check.
+bool CopyWorker::reserveJobSpace(uintmax_t bytes) {
+	m_reservationPath = (fs::path(m_destDir) / (".movero-reserve-" + std::to_string(getpid()))).string();
+	m_reservationFd = open(m_reservationPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+	if (m_reservationFd < 0) {
+		LOG(LogLevel::WARNING) << "Could not create space reservation file:" << strerror(errno);
+		return true;
+	}
+
+	if (fallocate(m_reservationFd, 0, 0, bytes) != 0) {
+		int err = errno;
+		releaseJobSpace();
+
+		if (err == ENOSPC || err == EDQUOT) {
+			std::error_code ec;
+			uintmax_t available = fs::space(m_destDir, ec).available;
+			emit errorOccurred({DiskFull,
+				"",
+				QString("%1|%2")
+				.arg(bytes / (1024.0 * 1024.0 * 1024.0), 0, 'f', 2)
+				.arg(available / (1024.0 * 1024.0 * 1024.0), 0, 'f', 2)});
+			return false;
+		}
+		LOG(LogLevel::INFO) << "Space reservation not supported:" << strerror(err) << "- checking space per file.";
+		return true;
+	}
+
+	m_reservedBytes = bytes;
+	LOG(LogLevel::INFO) << "Reserved" << bytes << "bytes for the job.";
+	return true;
+}
+
+
+// Gives 'bytes' of the reservation back right before a file of that size is written.
+void CopyWorker::shrinkJobSpace(uintmax_t bytes) {
+	QMutexLocker locker(&m_reservationMutex);
+	if (m_reservationFd < 0)
+		return;
+
+	m_reservedBytes -= std::min(bytes, m_reservedBytes);
+	if (ftruncate(m_reservationFd, m_reservedBytes) != 0) {
+		LOG(LogLevel::WARNING) << "Failed to shrink space reservation:" << strerror(errno);
+	}
+}
+
+
+// Removes the reservation file and frees whatever is left of it.
+void CopyWorker::releaseJobSpace() {
+	QMutexLocker locker(&m_reservationMutex);
+	if (m_reservationFd < 0)
+		return;
+
+	close(m_reservationFd);
+	unlink(m_reservationPath.c_str());
+	m_reservationFd = -1;
+	m_reservedBytes = 0;
+}
+
+
+// Writes one chunk to the destination at the current file offset.
+// With O_DIRECT every write must be a multiple of ALIGNMENT (the buffers are already aligned):
+// the tail of the file is zero-padded and trimmed with ftruncate() after the copy, any other
+// unaligned chunk (a short read) switches the file back to buffered writes.
+// 'data' must have room for the padding, which is always true for BufferRing buffers.
+bool CopyWorker::writeChunk(FileTransfer &ft, char *data, size_t len) {
+	size_t writeLen = len;
+	if (ft.directWrite && len % ALIGNMENT != 0) {
+		if (ft.totalRead + (qint64)len == ft.fileSize) {
+			writeLen = (len + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+			memset(data + len, 0, writeLen - len);
+			ft.needsTruncate = true;
+		} else {
+			fcntl(ft.fd_out, F_SETFL, fcntl(ft.fd_out, F_GETFL) & ~O_DIRECT);
+			ft.directWrite = false;
+		}
+	}
+
+	size_t written = 0;
+	while (written < writeLen) {
+		ssize_t n = write(ft.fd_out, data + written, writeLen - written);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			break;
+		written += n;
+	}
+	return written == writeLen;
+}
+
+
+// Accounts for bytes that reached the destination and refreshes the UI.
+void CopyWorker::onBytesCopied(FileTransfer &ft, size_t bytes) {
+	ft.totalRead += bytes;
+	m_totalBytesProcessed += bytes;
+	// O_DIRECT writes leave no dirty pages behind
+	if (!ft.directWrite)
+		m_unflushedBytes += bytes;
+	m_totalBytesCopied += bytes;
+
+	rollWriteback(ft);
+
+	// Calculate and update speed
+	updateProgress(ft.src, ft.dest, ft.totalRead, ft.fileSize);
+}
+
+
+// Accounts for a hole of a sparse file: progress only, nothing was written, so no dirty
+// pages to count and no writeback to start.
+void CopyWorker::onHoleSkipped(FileTransfer &ft, size_t bytes) {
+	ft.totalRead += bytes;
+	m_totalBytesProcessed += bytes;
+	m_totalBytesCopied += bytes;
+
+	updateProgress(ft.src, ft.dest, ft.totalRead, ft.fileSize);
+}
+
+
+// Rolling writeback: every WRITEBACK_WINDOW_MB, start the writeback of the range just written
+// (N) and wait for the one before it (N-1), whose writeback had a whole window of time to finish.
+// Without it the kernel collects gigabytes of dirty pages for a slow USB disk and the whole
+// desktop stalls while they are flushed; with it the dirty data stays around two windows and
+// the sync at the end of the file has almost nothing left to do.
+// Expects sequential writes: ranges are tracked by the number of bytes copied.
+void CopyWorker::rollWriteback(FileTransfer &ft) {
+	const qint64 window = (qint64)Config::WRITEBACK_WINDOW_MB * 1024 * 1024;
+	if (window <= 0 || ft.directWrite || Config::DRY_RUN || ft.totalRead - ft.writebackStarted < window)
+		return;
+
+	// Range N-1
+	if (ft.writebackStarted > ft.writebackWaited) {
+		qint64 len = ft.writebackStarted - ft.writebackWaited;
+		sync_file_range(ft.fd_out, ft.writebackWaited, len,
+						SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+		ft.writebackWaited = ft.writebackStarted;
+
+		// Those pages are clean now. Other files may have reset the counter in the meantime.
+		uintmax_t unflushed = m_unflushedBytes;
+		while (!m_unflushedBytes.compare_exchange_weak(unflushed, unflushed - std::min<uintmax_t>(unflushed, len))) {
+		}
+	}
+
+	// Range N, without waiting
+	sync_file_range(ft.fd_out, ft.writebackStarted, ft.totalRead - ft.writebackStarted, SYNC_FILE_RANGE_WRITE);
+	ft.writebackStarted = ft.totalRead;
+}
+
+
+// Synchronous engine: read() -> hash -> write() on a single buffer.
+// Also used for dry runs and for files that fit in one buffer.
+void CopyWorker::copyWithReadWrite(FileTransfer &ft, char *buffer, size_t bufferSize) {
+	while (ft.totalRead < ft.fileSize) {
+		if (m_cancelled) break;
+
+		waitIfPaused();
+
+		size_t toRead = std::min((qint64)bufferSize, ft.fileSize - ft.totalRead);
+		ssize_t bytesRead;
+
+		if (Config::DRY_RUN) {
+			bytesRead = toRead; // Simulate reading from disk
+			// Simulate disk latency (roughly 10ms for a mechanical seek/read)
+			// This prevents the "instant" processing that causes GB/s spikes
+			QThread::msleep(10);
+		} else {
+			bytesRead = read(ft.fd_in, buffer, toRead);
+		}
+
+		if (bytesRead < 0) {
+			emit errorOccurred({ReadError, QString::fromStdString(ft.src.string())});
+			break;
+		}
+		if (bytesRead == 0) {
+			emit errorOccurred({UnexpectedEOF, QString::fromStdString(ft.src.string())});
+			break;
+		}
+
+		// Calculate Hash on the fly
+		if (ft.hasher) {
+			ft.hasher->update(buffer, bytesRead);
+		}
+
+		// Write
+		if (!writeChunk(ft, buffer, bytesRead)) {
+			emit errorOccurred({WriteError, QString::fromStdString(ft.src.string())});
+			break;
+		}
+
+		onBytesCopied(ft, bytesRead);
+	}
+}
+
+
+// True if the block is all zeros. memcmp against itself shifted by one byte lets glibc's
+// vectorized (SSE2/AVX2/NEON) memcmp do the scan.
+static bool isZeroBlock(const char *data, size_t len) {
+	return len == 0 || (data[0] == 0 && memcmp(data, data + 1, len - 1) == 0);
+}
+
+
+// Sparse engine: walks the source with SEEK_DATA/SEEK_HOLE, copies only the data extents and
+// leaves the holes unallocated in the destination. With SPARSIFY_ZERO_RUNS, all-zero blocks
+// inside the data extents are not written either. Holes are hashed as zeros, so the checksum
+// still covers the logical contents of the file.
+// Returns false (nothing copied) if the source filesystem doesn't support SEEK_DATA.
+bool CopyWorker::copyWithSparse(FileTransfer &ft, char *buffer, size_t bufferSize) {
+	if (lseek(ft.fd_in, 0, SEEK_DATA) < 0 && errno != ENXIO) {
+		return false; // EINVAL: not supported
+	}
+
+	// pwrite() at arbitrary extent boundaries, so keep the page cache
+	if (ft.directWrite) {
+		fcntl(ft.fd_out, F_SETFL, fcntl(ft.fd_out, F_GETFL) & ~O_DIRECT);
+		ft.directWrite = false;
+	}
+
+	qint64 offset = 0;
+	while (offset < ft.fileSize) {
+		// Next data extent. ENXIO: only a hole is left until EOF.
+		off_t dataStart = lseek(ft.fd_in, offset, SEEK_DATA);
+		if (dataStart < 0 && errno != ENXIO) {
+			emit errorOccurred({ReadError, QString::fromStdString(ft.src.string())});
+			return true;
+		}
+		if (dataStart < 0 || dataStart > ft.fileSize)
+			dataStart = ft.fileSize;
+
+		off_t dataEnd = ft.fileSize;
+		if (dataStart < ft.fileSize) {
+			dataEnd = std::min<off_t>(lseek(ft.fd_in, dataStart, SEEK_HOLE), ft.fileSize);
+			if (dataEnd < 0) {
+				emit errorOccurred({ReadError, QString::fromStdString(ft.src.string())});
+				return true;
+			}
+		}
+
+		// Hole: nothing to write, hash it as zeros
+		if (dataStart > offset) {
+			size_t zeroLen = std::min<qint64>(bufferSize, dataStart - offset);
+			memset(buffer, 0, zeroLen);
+			while (offset < dataStart) {
+				if (m_cancelled)
+					return true;
+
+				waitIfPaused();
+
+				size_t len = std::min<qint64>(zeroLen, dataStart - offset);
+				if (ft.hasher)
+					ft.hasher->update(buffer, len);
+				onHoleSkipped(ft, len);
+				offset += len;
+			}
+		}
+
+		// Data extent
+		while (offset < dataEnd) {
+			if (m_cancelled)
+				return true;
+
+			waitIfPaused();
+
+			size_t toRead = std::min<qint64>(bufferSize, dataEnd - offset);
+			ssize_t n;
+			do {
+				n = pread(ft.fd_in, buffer, toRead, offset);
+			} while (n < 0 && errno == EINTR);
+
+			if (n <= 0) {
+				emit errorOccurred({n == 0 ? UnexpectedEOF : ReadError, QString::fromStdString(ft.src.string())});
+				return true;
+			}
+
+			if (ft.hasher)
+				ft.hasher->update(buffer, n);
+
+			if (!writeSparseChunk(ft, buffer, n, offset)) {
+				emit errorOccurred({WriteError, QString::fromStdString(ft.src.string())});
+				return true;
+			}
+
+			onBytesCopied(ft, n);
+			offset += n;
+		}
+	}
+
+	// Trailing holes were never written, ftruncate() sets the final size
+	ft.needsTruncate = true;
+	return true;
+}
+
+
+// Writes a chunk at 'offset'. With SPARSIFY_ZERO_RUNS, all-zero blocks are skipped
+// so they become holes; only the runs of non-zero blocks are written.
+bool CopyWorker::writeSparseChunk(FileTransfer &ft, const char *data, size_t len, qint64 offset) {
+	size_t pos = 0;
+	while (pos < len) {
+		size_t runStart = pos;
+		size_t runEnd = len;
+
+		if (Config::SPARSIFY_ZERO_RUNS) {
+			// Skip zero blocks, then extend the run until the next zero block
+			while (runStart < len && isZeroBlock(data + runStart, std::min(ALIGNMENT, len - runStart)))
+				runStart += ALIGNMENT;
+			if (runStart >= len)
+				return true;
+
+			runEnd = runStart;
+			while (runEnd < len && !isZeroBlock(data + runEnd, std::min(ALIGNMENT, len - runEnd)))
+				runEnd += ALIGNMENT;
+			runEnd = std::min(runEnd, len);
+		}
+
+		while (runStart < runEnd) {
+			ssize_t n = pwrite(ft.fd_out, data + runStart, runEnd - runStart, offset + runStart);
+			if (n < 0 && errno == EINTR)
+				continue;
+			if (n <= 0)
+				return false;
+			runStart += n;
+		}
+		pos = runEnd;
+	}
+	return true;
+}
+
+
+// In-kernel engine: copy_file_range() moves the data without copying it through user space,
+// and lets NFS/SMB do server-side copies and XFS/btrfs share extents.
+// When checksums are on, each chunk is read back from the source with pread() for hashing
+// (it's usually still in the page cache). Returns false if the kernel can't offload this
+// pair of files; the caller then continues with the read/write loop.
+bool CopyWorker::copyWithCopyFileRange(FileTransfer &ft, char *buffer, size_t bufferSize) {
+	while (ft.totalRead < ft.fileSize) {
+		if (m_cancelled) break;
+
+		waitIfPaused();
+
+		size_t toCopy = std::min((qint64)bufferSize, ft.fileSize - ft.totalRead);
+
+		// Null offsets: both file offsets advance, so a fallback can continue with read()/write()
+		ssize_t copied = copy_file_range(ft.fd_in, nullptr, ft.fd_out, nullptr, toCopy, 0);
+
+		if (copied < 0) {
+			if (errno == EINTR)
+				continue;
+			// EXDEV: cross-filesystem on kernels older than 5.3
+			// ENOSYS/EOPNOTSUPP/EINVAL: not supported by the kernel or filesystem
+			if (errno == EXDEV || errno == ENOSYS || errno == EOPNOTSUPP || errno == EINVAL) {
+				LOG(LogLevel::DEBUG) << "copy_file_range not usable:" << strerror(errno) << "- using read/write loop.";
+				return false;
+			}
+			emit errorOccurred({WriteError, QString::fromStdString(ft.src.string())});
+			break;
+		}
+		if (copied == 0) {
+			emit errorOccurred({UnexpectedEOF, QString::fromStdString(ft.src.string())});
+			break;
+		}
+
+		// Hash the same range of the source
+		if (ft.hasher) {
+			size_t hashed = 0;
+			while (hashed < (size_t)copied) {
+				ssize_t n = pread(ft.fd_in, buffer, copied - hashed, ft.totalRead + hashed);
+				if (n < 0 && errno == EINTR)
+					continue;
+				if (n <= 0)
+					break;
+				ft.hasher->update(buffer, n);
+				hashed += n;
+			}
+			if (hashed != (size_t)copied) {
+				emit errorOccurred({ReadError, QString::fromStdString(ft.src.string())});
+				break;
+			}
+		}
+
+		onBytesCopied(ft, copied);
+	}
+	return true;
+}
+
+
+// mmap engine: maps the source and feeds the hash and write() directly from the mapping,
+// which saves the kernel-to-user copy of read(). Best for sources that are already in the
+// page cache. Returns false (nothing copied) if the file can't be mapped, or when
+// 'onlyIfCached' is set and the source is remote or mostly not cached.
+bool CopyWorker::copyWithMmap(FileTransfer &ft, size_t chunkSize, bool onlyIfCached) {
+	if (onlyIfCached && !isLocalFileSystem(ft.fd_in))
+		return false;
+
+	const size_t size = static_cast<size_t>(ft.fileSize);
+	void *map = mmap(nullptr, size, PROT_READ, MAP_SHARED, ft.fd_in, 0);
+	if (map == MAP_FAILED) {
+		LOG(LogLevel::DEBUG) << "mmap failed:" << strerror(errno) << "-" << ft.src.c_str();
+		return false;
+	}
+
+	if (onlyIfCached && residentFraction(map, size) < 0.5) {
+		munmap(map, size);
+		return false;
+	}
+
+	madvise(map, size, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+	madvise(map, size, MADV_HUGEPAGE); // Fewer page faults where the filesystem supports it
+#endif
+
+	// The mapping is read-only, so the O_DIRECT tail can't be padded in place
+	if (ft.directWrite) {
+		fcntl(ft.fd_out, F_SETFL, fcntl(ft.fd_out, F_GETFL) & ~O_DIRECT);
+		ft.directWrite = false;
+	}
+
+	const char *data = static_cast<const char *>(map);
+
+	sigjmp_buf jump;
+	if (sigsetjmp(jump, 1) != 0) {
+		// SIGBUS: the source was truncated while we were reading it.
+		// The handler stays installed, so drop the target before this frame is gone
+		t_sigbusJump = nullptr;
+		munmap(map, size);
+		emit errorOccurred({UnexpectedEOF, QString::fromStdString(ft.src.string())});
+		return true;
+	}
+
+	while (ft.totalRead < ft.fileSize) {
+		if (m_cancelled) break;
+
+		waitIfPaused();
+
+		size_t len = std::min((qint64)chunkSize, ft.fileSize - ft.totalRead);
+		const char *chunk = data + ft.totalRead;
+
+		// Only the hasher touches the pages from userspace: write() reports a
+		// missing page as EFAULT instead of raising SIGBUS
+		if (ft.hasher) {
+			t_sigbusJump = &jump;
+			ft.hasher->update(chunk, len);
+			t_sigbusJump = nullptr;
+		}
+
+		if (!writeChunk(ft, const_cast<char *>(chunk), len)) {
+			emit errorOccurred({WriteError, QString::fromStdString(ft.src.string())});
+			break;
+		}
+
+		onBytesCopied(ft, len);
+	}
+
+	munmap(map, size);
+	return true;
+}
+
+
+// Parallel engine for very large files: up to PARALLEL_COPY_THREADS threads (one per ring
+// buffer) claim chunks through an atomic counter and copy them with pread()/pwrite() at
+// independent offsets, keeping several requests in flight on the device.
+// The file hash is a streaming hash, so the chunks are hashed strictly in order: each thread waits
+// for its turn before hashing. Reads and writes of the other chunks continue meanwhile.
+// The worker thread only reports progress and handles pause/cancel.
+void CopyWorker::copyWithParallelChunks(FileTransfer &ft) {
+	BufferRing &ring = *ft.io->ring;
+	const size_t chunkSize = ring.chunkSize();
+	const qint64 chunkCount = (ft.fileSize + chunkSize - 1) / chunkSize;
+	const size_t threadCount = std::min<size_t>({(size_t)Config::PARALLEL_COPY_THREADS, ring.count(), (size_t)chunkCount});
+
+	std::atomic<qint64> nextChunk{0};
+	std::atomic<qint64> copied{0};
+	std::atomic<int> failure{NoError}; // First error wins, the others stop claiming chunks
+	std::atomic<size_t> running{threadCount};
+	std::atomic<bool> paddedTail{false};
+
+	std::mutex hashMutex;
+	std::condition_variable hashCond;
+	qint64 nextToHash = 0; // Protected by hashMutex
+
+	auto fail = [&](ErrorType type) {
+		int expected = NoError;
+		failure.compare_exchange_strong(expected, type);
+		hashCond.notify_all(); // Don't leave anyone waiting for a chunk that will never be hashed
+	};
+
+	auto copyChunks = [&](char *buffer) {
+		while (failure == NoError && !m_cancelled) {
+			qint64 index = nextChunk++;
+			if (index >= chunkCount)
+				break;
+
+			waitIfPaused();
+
+			const qint64 offset = index * chunkSize;
+			const size_t len = std::min<qint64>(chunkSize, ft.fileSize - offset);
+
+			size_t done = 0;
+			ssize_t n = 0;
+			while (done < len) {
+				n = pread(ft.fd_in, buffer + done, len - done, offset + done);
+				if (n < 0 && errno == EINTR)
+					continue;
+				if (n <= 0)
+					break;
+				done += n;
+			}
+			if (done != len) {
+				fail(n == 0 ? UnexpectedEOF : ReadError);
+				break;
+			}
+
+			if (ft.hasher) {
+				std::unique_lock<std::mutex> lock(hashMutex);
+				hashCond.wait(lock, [&] { return nextToHash == index || failure != NoError || m_cancelled; });
+				if (nextToHash != index)
+					break;
+				ft.hasher->update(buffer, len);
+				nextToHash++;
+				lock.unlock();
+				hashCond.notify_all();
+			}
+
+			// O_DIRECT: only the tail can be unaligned, pad it (trimmed by the caller)
+			size_t writeLen = len;
+			if (ft.directWrite && len % ALIGNMENT != 0) {
+				writeLen = (len + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+				memset(buffer + len, 0, writeLen - len);
+				paddedTail = true;
+			}
+
+			done = 0;
+			while (done < writeLen) {
+				n = pwrite(ft.fd_out, buffer + done, writeLen - done, offset + done);
+				if (n < 0 && errno == EINTR)
+					continue;
+				if (n <= 0)
+					break;
+				done += n;
+			}
+			if (done != writeLen) {
+				fail(WriteError);
+				break;
+			}
+
+			copied += len;
+			m_totalBytesProcessed += len;
+			m_totalBytesCopied += len;
+		}
+		running--;
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount);
+	for (size_t i = 0; i < threadCount; ++i) {
+		threads.emplace_back(copyChunks, ring.buffer(i));
+	}
+
+	// Report progress while the threads work
+	const qint64 writebackWindow = (qint64)Config::WRITEBACK_WINDOW_MB * 1024 * 1024;
+	qint64 writebackAt = writebackWindow;
+	while (running > 0) {
+		waitIfPaused();
+		if (m_cancelled)
+			hashCond.notify_all();
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		updateProgress(ft.src, ft.dest, copied, ft.fileSize);
+
+		// Rolling writeback (see rollWriteback). The chunks finish out of order, so wait for
+		// the writeback started last time and start it for everything dirty since.
+		if (writebackWindow > 0 && !ft.directWrite && copied >= writebackAt) {
+			sync_file_range(ft.fd_out, 0, 0, SYNC_FILE_RANGE_WAIT_BEFORE);
+			sync_file_range(ft.fd_out, 0, 0, SYNC_FILE_RANGE_WRITE);
+			writebackAt = copied + writebackWindow;
+		}
+	}
+	for (auto &thread : threads) {
+		thread.join();
+	}
+
+	ft.totalRead = copied;
+	if (!ft.directWrite)
+		m_unflushedBytes += copied;
+	if (paddedTail)
+		ft.needsTruncate = true;
+
+	if (failure != NoError) {
+		emit errorOccurred({static_cast<ErrorType>(failure.load()), QString::fromStdString(ft.src.string())});
+	}
+}
+
+
+// Window engine for copies within one spinning disk: reads up to HDD_WINDOW_MB of the source,
+// then writes it out and waits for the writeback of that range before reading on. The heads
+// make one long sequential pass per window in each direction instead of seeking between source
+// and destination for every buffer (the writeback of a buffered write would otherwise run
+// interleaved with the next reads).
+// Returns false (nothing copied) if the window can't be allocated.
+bool CopyWorker::copyWithWindow(FileTransfer &ft) {
+	IoContext &io = *ft.io;
+	const size_t chunkSize = io.ring->chunkSize();
+	const size_t wanted = (size_t)Config::HDD_WINDOW_MB * 1024 * 1024;
+
+	if (!io.window || io.window->bufferSize() < std::min<size_t>(wanted, ft.fileSize)) {
+		// Small files don't need the full window, it grows when a bigger one comes along
+		io.window.reset();
+		io.window = std::make_unique<BufferRing>(1, std::min<size_t>(wanted, ft.fileSize));
+		if (!io.window->isValid()) {
+			LOG(LogLevel::WARNING) << "Could not allocate the HDD window, copying per buffer.";
+			io.window.reset();
+			return false;
+		}
+	}
+	char *window = io.window->buffer(0);
+	const size_t windowSize = io.window->bufferSize();
+
+	while (ft.totalRead < ft.fileSize && !m_cancelled) {
+		const qint64 windowStart = ft.totalRead;
+		const size_t windowLen = std::min<qint64>(windowSize, ft.fileSize - windowStart);
+
+		// Read phase: the whole window, one buffer-sized request at a time
+		size_t filled = 0;
+		while (filled < windowLen && !m_cancelled) {
+			waitIfPaused();
+			size_t toRead = std::min(chunkSize, windowLen - filled);
+			ssize_t n = read(ft.fd_in, window + filled, toRead);
+			if (n < 0 && errno == EINTR)
+				continue;
+			if (n < 0) {
+				emit errorOccurred({ReadError, QString::fromStdString(ft.src.string())});
+				return true;
+			}
+			if (n == 0) {
+				emit errorOccurred({UnexpectedEOF, QString::fromStdString(ft.src.string())});
+				return true;
+			}
+			filled += n;
+		}
+		if (m_cancelled)
+			break;
+
+		if (ft.hasher) {
+			ft.hasher->update(window, windowLen);
+		}
+
+		// Write phase: the whole window in one burst
+		size_t written = 0;
+		while (written < windowLen && !m_cancelled) {
+			waitIfPaused();
+			size_t len = std::min(chunkSize, windowLen - written);
+			if (!writeChunk(ft, window + written, len)) {
+				emit errorOccurred({WriteError, QString::fromStdString(ft.src.string())});
+				return true;
+			}
+			written += len;
+			onBytesCopied(ft, len);
+		}
+
+		// Push the window to the disk now, so its writeback doesn't seek against the next reads
+		if (!ft.directWrite) {
+			sync_file_range(ft.fd_out, windowStart, windowLen,
+							SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+		}
+	}
+	return true;
+}
+
+
+// Pipeline engine: a reader thread fills the buffer ring while this thread hashes
+// and writes the filled buffers in order. Used when io_uring is not available.
+void CopyWorker::copyWithPipeline(FileTransfer &ft) {
+	BufferRing &ring = *ft.io->ring;
+	ring.reset();
+	const qint64 start = ft.totalRead; // Non-zero after a copy_file_range fallback
+
+	std::thread reader([&ring, &ft, start]() {
+		qint64 offset = start;
+		while (offset < ft.fileSize) {
+			char *buf = ring.acquireFree();
+			if (!buf)
+				return; // Writer stopped
+
+			size_t toRead = std::min((qint64)ring.chunkSize(), ft.fileSize - offset);
+			ssize_t n;
+			do {
+				n = read(ft.fd_in, buf, toRead);
+			} while (n < 0 && errno == EINTR);
+
+			if (n < 0) {
+				ring.finish(errno);
+				return;
+			}
+			if (n == 0) {
+				ring.finish(ENODATA); // File shrank while copying
+				return;
+			}
+			ring.commitFilled(n);
+			offset += n;
+		}
+		ring.finish(0);
+	});
+
+	bool writeFailed = false;
+	char *data = nullptr;
+	size_t len = 0;
+
+	while (ring.acquireFilled(data, len)) {
+		if (m_cancelled)
+			break;
+
+		// The reader keeps filling the ring while we wait, then blocks
+		waitIfPaused();
+
+		if (ft.hasher) {
+			ft.hasher->update(data, len);
+		}
+
+		bool written = writeChunk(ft, data, len);
+		ring.releaseFilled();
+
+		if (!written) {
+			writeFailed = true;
+			emit errorOccurred({WriteError, QString::fromStdString(ft.src.string())});
+			break;
+		}
+		onBytesCopied(ft, len);
+	}
+
+	// Wake the reader if we stopped early, then wait for it
+	ring.close();
+	reader.join();
+
+	if (!writeFailed && !m_cancelled && ft.totalRead != ft.fileSize) {
+		if (ring.error() == ENODATA) {
+			emit errorOccurred({UnexpectedEOF, QString::fromStdString(ft.src.string())});
+		} else {
+			emit errorOccurred({ReadError, QString::fromStdString(ft.src.string())});
+		}
+	}
+}
+
+
+// io_uring engine: keeps IO_QUEUE_DEPTH chunks in flight so reading the next
+// chunk overlaps with writing the previous one.
+void CopyWorker::copyWithUring(FileTransfer &ft) {
+	UringEngine::Result result = ft.io->uring->copy(
+		ft.fd_in,
+		ft.fd_out,
+		ft.fileSize,
+		[&ft](const char *data, size_t len) {
+			// Chunks arrive in file order, so the streaming hash stays valid
+			if (ft.hasher)
+				ft.hasher->update(data, len);
+		},
+		[this, &ft](size_t bytes) {
+			onBytesCopied(ft, bytes);
+			waitIfPaused();
+			return !m_cancelled;
+		},
+		ft.directWrite
+	);
+
+	// The engine padded the last chunk for O_DIRECT
+	if (ft.directWrite && ft.fileSize % ALIGNMENT != 0) {
+		ft.needsTruncate = true;
+	}
+
+	switch (result) {
+		case UringEngine::ReadFailed:
+			emit errorOccurred({ReadError, QString::fromStdString(ft.src.string())});
+			break;
+		case UringEngine::UnexpectedEOF:
+			emit errorOccurred({UnexpectedEOF, QString::fromStdString(ft.src.string())});
+			break;
+		case UringEngine::WriteFailed:
+			emit errorOccurred({WriteError, QString::fromStdString(ft.src.string())});
+			break;
+		default: // Ok or Aborted (cancelled by the user)
+			break;
+	}
+}
+
+
+// Time spent paused since the job started, including a pause that is still going on
+std::chrono::duration<double> CopyWorker::pausedTime() {
+	QMutexLocker locker(&m_progressMutex);
+	std::chrono::duration<double> paused = m_totalPausedDuration;
+	if (m_paused)
+		paused += std::chrono::steady_clock::now() - m_pauseStart;
+	return paused;
+}
+
+
+// Blocks while the job is paused. Safe to call from several threads at once
+// (pool workers, parallel chunk copy), the paused time is accounted in resume().
+void CopyWorker::waitIfPaused() {
+	if (!m_paused)
+		return;
+
+	QMutexLocker locker(&m_sync);
+	// Checked under the lock so a resume() between the check and the wait isn't missed
+	while (m_paused && !m_cancelled) {
+		m_pauseCond.wait(&m_sync);
+	}
+}
+
+
+// Reads block 'block' of a destination file and hashes it like ChunkHasher does.
+// 'direct': fd has O_DIRECT set, so reads are rounded up to ALIGNMENT (EOF shortens the tail).
+// Returns false if the block couldn't be read completely.
+static bool hashFileBlock(int fd, uint64_t block, uint64_t fileSize, char *buffer, size_t bufferSize, bool direct,
+						  XXH3_state_t *state, uint64_t &hash) {
+	constexpr size_t alignment = BufferRing::ALIGNMENT;
+	uint64_t offset = block * ChunkHasher::HASH_BLOCK_SIZE;
+	uint64_t len = std::min<uint64_t>(ChunkHasher::HASH_BLOCK_SIZE, fileSize - offset);
+	uint64_t done = 0;
+	XXH3_64bits_reset(state);
+
+	while (done < len) {
+		size_t toRead = std::min<uint64_t>(bufferSize, len - done);
+		if (direct)
+			toRead = std::min(bufferSize, (toRead + alignment - 1) & ~(alignment - 1));
+
+		ssize_t n = pread(fd, buffer, toRead, offset + done);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		size_t valid = std::min<uint64_t>(n, len - done);
+		XXH3_64bits_update(state, buffer, valid);
+		done += valid;
+	}
+	hash = XXH3_64bits_digest(state);
+	return true;
+}
+
+
+// True if a file of 'size' bytes is verified by sampling instead of a full read-back
+bool CopyWorker::useSampling(uintmax_t size) {
+	return Config::CHECKSUM_ENABLED && Config::SAMPLED_VERIFY && size > 0 &&
+		   size >= (uintmax_t)Config::VERIFY_SAMPLE_MIN_MB * 1024 * 1024;
+}
+
+
+// Number of blocks read back when sampling a file of 'size' bytes (at least one)
+uint64_t CopyWorker::sampledBlocks(uintmax_t size) {
+	uint64_t blocks = ChunkHasher::blockCount(size);
+	uint64_t percent = std::clamp(Config::VERIFY_SAMPLE_PERCENT, 1, 100);
+	return std::clamp<uint64_t>((blocks * percent + 99) / 100, 1, blocks);
+}
+
+
+// Progress a file of 'size' bytes accounts for: the copy plus its verification
+uintmax_t CopyWorker::workBytes(uintmax_t size) {
+	if (!Config::CHECKSUM_ENABLED)
+		return size;
+	if (useSampling(size))
+		return size + std::min<uintmax_t>(size, sampledBlocks(size) * ChunkHasher::HASH_BLOCK_SIZE);
+	return size * 2;
+}
+
+
+// Sampled verification: reads a random VERIFY_SAMPLE_PERCENT of the blocks back from the disk
+// with O_DIRECT and compares each with the block hash taken while copying.
+// The last block is always included: fake-capacity flash drives lose or wrap the data
+// beyond their real size, so the end of a large file is where they fail first.
+bool CopyWorker::verifySample(const PendingFile &file, int fd, IoContext &io, bool isLastFile) {
+	const uint64_t blocks = file.blockHashes.size();
+	const uint64_t count = sampledBlocks(file.size);
+
+	if (!file.background)
+		emit statusChanged(Verifying); // Update UI status
+
+	// Floyd's algorithm: count - 1 distinct blocks out of all but the last, sorted by offset
+	std::set<uint64_t> picked{blocks - 1};
+	std::mt19937_64 rng(std::random_device{}());
+	for (uint64_t j = blocks - count; j < blocks - 1; ++j) {
+		uint64_t t = std::uniform_int_distribution<uint64_t>(0, j)(rng);
+		if (!picked.insert(t).second)
+			picked.insert(j);
+	}
+
+	int originalFlags = fcntl(fd, F_GETFL);
+	bool useDirect = (fcntl(fd, F_SETFL, originalFlags | O_DIRECT) == 0);
+
+	char *buffer = io.ring->buffer(0);
+	size_t bufferSize = io.ring->chunkSize();
+	XXH3_state_t *state = XXH3_createState();
+	bool ok = true;
+
+	for (uint64_t block : picked) {
+		if (m_cancelled) {
+			ok = false;
+			break;
+		}
+		waitIfPaused();
+
+		uint64_t hash = 0;
+		if (!hashFileBlock(fd, block, file.size, buffer, bufferSize, useDirect, state, hash) ||
+			hash != file.blockHashes[block]) {
+			LOG(LogLevel::ERROR) << "Sampled block" << block << "of" << blocks << "differs:" << file.dest.c_str();
+			ok = false;
+			break;
+		}
+	}
+
+	XXH3_freeState(state);
+	if (useDirect)
+		fcntl(fd, F_SETFL, originalFlags);
+
+	m_totalBytesProcessed += workBytes(file.size) - file.size;
+
+	// Force 100% and reset speed graph after verification
+	if (!file.background || isLastFile) {
+		int totalPercent = isLastFile ? 100 : (int)((m_totalBytesProcessed * 100) / m_totalWorkBytes);
+		emit progressChanged(
+			QString::fromStdString(file.src.string()),
+			QString::fromStdString(file.dest.string()),
+			100, totalPercent, 0, 0, 0
+		);
+	}
+
+	LOG(LogLevel::DEBUG) << "Sampled" << picked.size() << "of" << blocks << "blocks:" << file.dest.c_str();
+	return ok;
+}
+
+
+// Reads blocks of the destination back and compares each with its source hash ('blocks' lists
+// the block numbers, empty means all). Large files are split between PARALLEL_COPY_THREADS
+// threads, which keeps a fast array busy at a higher queue depth; never on a spinning disk.
+// 'actual' receives the hash of every block read, 'badBlocks' the mismatches in ascending order.
+// 'countProgress': the bytes read are part of the job's verification work.
+// Returns false if cancelled.
+bool CopyWorker::checkBlocks(const PendingFile &file, int fd, IoContext &io, const std::vector<uint64_t> &blocks,
+							 std::vector<uint64_t> &actual, std::vector<uint64_t> &badBlocks, bool countProgress) {
+	const std::vector<uint64_t> &expected = file.blockHashes;
+	const uint64_t count = blocks.empty() ? expected.size() : blocks.size();
+	badBlocks.clear();
+	actual.assign(expected.size(), 0);
+	if (count == 0)
+		return !m_cancelled;
+
+	// Several readers only pay off on large files and never on a spinning disk
+	struct stat st;
+	size_t threadCount = 1;
+	if (count * ChunkHasher::HASH_BLOCK_SIZE >= (uintmax_t)Config::PARALLEL_COPY_THRESHOLD_MB * 1024 * 1024 &&
+		fstat(fd, &st) == 0 && !m_scheduler.isRotational(st.st_dev)) {
+		threadCount = (size_t)std::clamp<uint64_t>(Config::PARALLEL_COPY_THREADS, 1, count);
+	}
+
+	// One block-sized buffer per reader. Without them, read with the thread's own buffer.
+	std::unique_ptr<BufferRing> buffers;
+	if (threadCount > 1) {
+		buffers = std::make_unique<BufferRing>(threadCount, ChunkHasher::HASH_BLOCK_SIZE);
+		if (!buffers->isValid()) {
+			buffers.reset();
+			threadCount = 1;
+		}
+	}
+
+	int originalFlags = fcntl(fd, F_GETFL);
+	bool useDirect = (file.size >= ALIGNMENT) && (fcntl(fd, F_SETFL, originalFlags | O_DIRECT) == 0);
+	if (!useDirect) {
+		posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+	}
+
+	std::vector<char> bad(expected.size(), 0);
+	std::atomic<uint64_t> next{0};
+	std::atomic<qint64> verified{0};
+
+	// Readers take the next unread block, so a slow range doesn't hold up the others
+	auto reader = [&](size_t index) {
+		char *buffer = buffers ? buffers->buffer(index) : io.ring->buffer(0);
+		size_t bufferSize = buffers ? buffers->bufferSize() : io.ring->chunkSize();
+		XXH3_state_t *state = XXH3_createState();
+
+		while (!m_cancelled) {
+			uint64_t i = next++;
+			if (i >= count)
+				break;
+			uint64_t block = blocks.empty() ? i : blocks[i];
+			waitIfPaused();
+
+			if (!hashFileBlock(fd, block, file.size, buffer, bufferSize, useDirect, state, actual[block]) ||
+				actual[block] != expected[block]) {
+				bad[block] = 1;
+			}
+
+			if (countProgress) {
+				qint64 len = std::min<uint64_t>(ChunkHasher::HASH_BLOCK_SIZE, file.size - block * ChunkHasher::HASH_BLOCK_SIZE);
+				m_totalBytesProcessed += len;
+				qint64 total = (verified += len);
+				if (!file.background)
+					updateProgress(file.src, file.dest, total, file.size);
+			}
+		}
+		XXH3_freeState(state);
+	};
+
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < threadCount; ++i) {
+		threads.emplace_back(reader, i);
+	}
+	reader(0);
+	for (auto &thread : threads) {
+		thread.join();
+	}
+
+	if (useDirect)
+		fcntl(fd, F_SETFL, originalFlags);
+
+	for (uint64_t block = 0; block < bad.size(); ++block) {
+		if (bad[block])
+			badBlocks.push_back(block);
+	}
+	return !m_cancelled;
+}
+
+
+// Hash tree verification (HASH_TREE): reads every block back, each compared with its own
+// source hash. On a mismatch 'badBlocks' holds the damaged blocks and 'badRanges' the
+// damaged byte ranges. 'diskHash' is the root of the destination's block hashes.
+bool CopyWorker::verifyTree(const PendingFile &file, int fd, IoContext &io, bool isLastFile, Hasher::Digest &diskHash,
+							std::vector<uint64_t> &badBlocks, QString &badRanges) {
+	if (!file.background)
+		emit statusChanged(Verifying); // Update UI status
+
+	std::vector<uint64_t> actual;
+	bool finished = checkBlocks(file, fd, io, {}, actual, badBlocks, true);
+
+	// Force 100% and reset speed graph after verification
+	if (!file.background || isLastFile) {
+		int totalPercent = isLastFile ? 100 : (int)((m_totalBytesProcessed * 100) / m_totalWorkBytes);
+		emit progressChanged(
+			QString::fromStdString(file.src.string()),
+			QString::fromStdString(file.dest.string()),
+			100, totalPercent, 0, 0, 0
+		);
+	}
+
+	if (!finished)
+		return false;
+
+	diskHash = Hasher::Digest::fromUint64(ChunkHasher::rootOf(actual));
+	if (badBlocks.empty())
+		return diskHash == file.srcHash;
+
+	badRanges = describeBlocks(file, badBlocks);
+	LOG(LogLevel::ERROR) << "Damaged ranges in" << file.dest.c_str() << ":" << badRanges;
+	return false;
+}
+
+
+// Byte ranges covered by 'blocks' (ascending), neighbouring blocks merged, e.g. "bytes 0-1048575".
+QString CopyWorker::describeBlocks(const PendingFile &file, const std::vector<uint64_t> &blocks) {
+	static constexpr int MAX_LISTED_RANGES = 10;
+	QStringList ranges;
+	int rangeCount = 0;
+
+	for (size_t i = 0; i < blocks.size(); ++i) {
+		uint64_t first = blocks[i];
+		while (i + 1 < blocks.size() && blocks[i + 1] == blocks[i] + 1)
+			++i;
+
+		if (++rangeCount <= MAX_LISTED_RANGES) {
+			uint64_t start = first * ChunkHasher::HASH_BLOCK_SIZE;
+			uint64_t end = std::min<uint64_t>((blocks[i] + 1) * ChunkHasher::HASH_BLOCK_SIZE, file.size);
+			ranges.append(tr("bytes %1-%2").arg(start).arg(end - 1));
+		}
+	}
+	if (rangeCount > MAX_LISTED_RANGES)
+		ranges.append(tr("%1 more").arg(rangeCount - MAX_LISTED_RANGES));
+	return ranges.join(", ");
+}
+
+
+// Rewrites the damaged blocks of a destination from the source and reads them back, up to
+// REPAIR_MAX_RETRIES times. 'badBlocks' may be empty when only the whole-file hash (or a sample)
+// failed; every block is checked first then. A source block that no longer matches the hash
+// taken while copying means the source changed, which can't be repaired.
+// Returns true once every block matches. 'repaired' is the number of blocks rewritten.
+bool CopyWorker::repairFile(const PendingFile &file, int fd, IoContext &io, std::vector<uint64_t> badBlocks, uint64_t &repaired) {
+	std::vector<uint64_t> actual;
+	if (badBlocks.empty()) {
+		if (!checkBlocks(file, fd, io, {}, actual, badBlocks, false))
+			return false;
+		// The whole-file hash failed, yet every block matches: nothing we can point at
+		if (badBlocks.empty())
+			return false;
+	}
+
+	int fdIn = open(file.src.c_str(), O_RDONLY);
+	int fdOut = open(file.dest.c_str(), O_WRONLY);
+	BufferRing block(1, ChunkHasher::HASH_BLOCK_SIZE);
+	if (fdIn < 0 || fdOut < 0 || !block.isValid()) {
+		LOG(LogLevel::ERROR) << "Can't repair" << file.dest.c_str() << ":" << strerror(errno);
+		if (fdIn >= 0)
+			close(fdIn);
+		if (fdOut >= 0)
+			close(fdOut);
+		return false;
+	}
+
+	if (!file.background)
+		emit statusChanged(Repairing);
+	char *buffer = block.buffer(0);
+	bool sourceChanged = false;
+	bool writeFailed = false;
+	repaired = 0;
+
+	for (int attempt = 1; attempt <= Config::REPAIR_MAX_RETRIES && !badBlocks.empty() && !m_cancelled; ++attempt) {
+		LOG(LogLevel::WARNING) << "Repairing" << badBlocks.size() << "blocks of" << file.dest.c_str()
+							   << "- attempt" << attempt << "of" << Config::REPAIR_MAX_RETRIES;
+
+		for (uint64_t index : badBlocks) {
+			uint64_t offset = index * ChunkHasher::HASH_BLOCK_SIZE;
+			size_t len = std::min<uint64_t>(ChunkHasher::HASH_BLOCK_SIZE, file.size - offset);
+
+			size_t done = 0;
+			while (done < len) {
+				ssize_t n = pread(fdIn, buffer + done, len - done, offset + done);
+				if (n < 0 && errno == EINTR)
+					continue;
+				if (n <= 0)
+					break;
+				done += n;
+			}
+			if (done != len || XXH3_64bits(buffer, len) != file.blockHashes[index]) {
+				sourceChanged = true;
+				break;
+			}
+
+			done = 0;
+			while (done < len) {
+				ssize_t n = pwrite(fdOut, buffer + done, len - done, offset + done);
+				if (n < 0 && errno == EINTR)
+					continue;
+				if (n <= 0)
+					break;
+				done += n;
+			}
+			if (done != len) {
+				writeFailed = true;
+				break;
+			}
+			repaired++;
+		}
+		if (sourceChanged) {
+			LOG(LogLevel::ERROR) << "Source changed since it was copied, can't repair:" << file.src.c_str();
+			break;
+		}
+		if (writeFailed) {
+			LOG(LogLevel::ERROR) << "Could not rewrite damaged blocks:" << file.dest.c_str() << strerror(errno);
+			break;
+		}
+
+		// Read the rewritten blocks back from the disk, not from the page cache
+		fdatasync(fdOut);
+		posix_fadvise(fdOut, 0, 0, POSIX_FADV_DONTNEED);
+
+		std::vector<uint64_t> stillBad;
+		if (!checkBlocks(file, fd, io, badBlocks, actual, stillBad, false))
+			break;
+		badBlocks.swap(stillBad);
+	}
+
+	close(fdIn);
+	close(fdOut);
+
+	if (!badBlocks.empty() || sourceChanged || writeFailed || m_cancelled)
+		return false;
+
+	LOG(LogLevel::INFO) << "Repaired" << repaired << "blocks of" << file.dest.c_str();
+	if (!file.background)
+		emit statusChanged(Verifying);
+	return true;
+}
+
+
+// Verifies the integrity of the copied file by reading it back from disk and comparing checksums.
+bool CopyWorker::verifyFile(
+	const std::filesystem::path &src,
+	const std::filesystem::path &dest,
+	int fd_dest,
+	const Hasher::Digest &expectedHash,
+	Hasher::Digest &outDiskHash,
+	IoContext &io,
+	bool isLastFile,
+	bool background) 
+{
+	char *buffer = io.ring->buffer(0);
+	size_t bufferSize = io.ring->chunkSize();
+
+	// uintmax_t syncThreshold = static_cast<uintmax_t>(Config::SYNC_THRESHOLD_MB) * 1024 * 1024;
+	// In the background the copy thread keeps reporting its own file and status.
+	// The verified bytes still count towards the total progress.
+	if (!background)
+		emit statusChanged(Verifying); // Update UI status
+	// LOG(LogLevel::DEBUG) << "Verifying file:" << src.c_str();
+
+	// Hybrid Strategy for Verification:
+	// Small files: Standard buffered read (fast, reads from Cache if we skipped fdatasync).
+	// Large files: O_DIRECT (safe, reads from Disk, requires fdatasync to have happened).
+	bool useDirect = false;
+	qint64 fileSize = fs::file_size(dest);
+
+	// Optimization: Skip O_DIRECT entirely for files smaller than alignment
+	if (fileSize >= ALIGNMENT) {
+	// if (fileSize >= syncThreshold && fileSize >= ALIGNMENT) {
+		useDirect = true;
+	}
+
+	// Reuse the existing file descriptor
+	int fd = fd_dest;
+	lseek(fd, 0, SEEK_SET);
+
+	// Try to enable O_DIRECT on the existing FD if requested
+	int originalFlags = fcntl(fd, F_GETFL);
+	if (useDirect) {
+		if (fcntl(fd, F_SETFL, originalFlags | O_DIRECT) < 0) {
+			useDirect = false; // Fallback to buffered if O_DIRECT fails
+		}
+	}
+	
+	if (!useDirect) {
+		// Hint sequential access for buffered reads
+		// If O_DIRECT failed, we try to clear the cache so we read from disk
+		// POSIX_FADV_DONTNEED in the fallback path: This attempts to clear the cache
+		// before reading, maximizing the chance of a physical disk read even without O_DIRECT.
+		posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+		posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+	}
+
+	std::unique_ptr<Hasher> hasher = Hasher::create(m_hashAlgorithm);
+
+	qint64 totalRead = 0;
+
+	// io_uring path: the engine rounds the O_DIRECT tail up to the block size
+	// and lets EOF shorten it, so O_DIRECT can stay on for the whole file.
+	if (io.uring && io.uring->isReady() && fileSize > (qint64)bufferSize) {
+		io.uring->read(
+			fd,
+			fileSize,
+			[&hasher](const char *data, size_t len) {
+				hasher->update(data, len);
+			},
+			[&](size_t bytes) {
+				totalRead += bytes;
+				m_totalBytesProcessed += bytes;
+				if (!background)
+					updateProgress(src, dest, totalRead, fileSize);
+				waitIfPaused();
+				return !m_cancelled;
+			}
+		);
+		// If the engine stopped early, the loop below continues from the last hashed chunk
+		lseek(fd, totalRead, SEEK_SET);
+	}
+
+	while (totalRead < fileSize) {
+		if (m_cancelled)
+			break;
+
+		waitIfPaused();
+
+		qint64 remaining = fileSize - totalRead;
+		size_t toRead = std::min((qint64)bufferSize, remaining);
+
+		// O_DIRECT handling: Read size must be aligned.
+		// If we are at the tail and it's not aligned, drop O_DIRECT.
+		if (useDirect && (toRead % ALIGNMENT != 0)) {
+			int currentFlags = fcntl(fd, F_GETFL);
+			fcntl(fd, F_SETFL, currentFlags & ~O_DIRECT);
+			useDirect = false; // Stays off for the remainder (which is just this last chunk)
+		}
+
+		ssize_t n = read(fd, buffer, toRead);
+		if (n <= 0)	break;
+
+		hasher->update(buffer, n);
+		totalRead += n;
+		m_totalBytesProcessed += n;
+		if (!background)
+			updateProgress(src, dest, totalRead, fileSize);
+	}
+
+	// Force 100% and reset speed graph after verification
+	int totalPercent = (int)((m_totalBytesProcessed * 100) / m_totalWorkBytes);
+
+	if (isLastFile)
+		totalPercent = 100;
+
+	if (!background || isLastFile) {
+		emit progressChanged(
+			QString::fromStdString(src.string()),
+			QString::fromStdString(dest.string()),
+			100, totalPercent, 0, 0, 0
+		);
+	}
+
+	outDiskHash = hasher->digest();
 
 	// Restore flags if we changed them (though we are about to close it in copyFile)
 	if (useDirect) {
@@ -5,10 +5,22 @@
 #include <QThread>
 #include <QWaitCondition>
 #include <atomic>
+#include <deque>
 #include <filesystem>
+#include <memory>
+#include <thread>
 #include <vector>
+#include <xxhash.h>
 
+#include "BufferRing.h"
+#include "BufferTuner.h"
+#include "ChunkHasher.h"
+#include "HashCache.h"
+#include "HashManifest.h"
+#include "Hasher.h"
 #include "Config.h"
+#include "IoScheduler.h"
+#include "UringEngine.h"
 
 class CopyWorker : public QThread {
 	Q_OBJECT
@@ -25,7 +37,8 @@ public:
 
 	enum Mode {
 		Copy,
-		Move
+		Move,
+		Compare // Nothing is written: the source tree is compared with the destination tree
 	};
 
 	enum ErrorType {
@@ -38,7 +51,12 @@ public:
 		UnexpectedEOF,
 		WriteError,
 		ChecksumMismatch,
-		DestinationIsDirectory
+		DestinationIsDirectory,
+		// Differences found in Compare mode
+		MissingInDestination,
+		ExtraInDestination,
+		SizeMismatch,
+		ContentMismatch
 	};
 	Q_ENUM(ErrorType)
 
@@ -61,7 +79,9 @@ public:
 		RemovingEmptyFolders,
 		Copying,
 		GeneratingHash,
-		Verifying
+		Verifying,
+		Repairing,
+		Comparing
 	};
 	Q_ENUM(Status)
 
@@ -70,6 +90,10 @@ public:
 	std::atomic<uintmax_t> m_totalBytesCopied{0}; // Total bytes written to disk (including partial)
 	CopyWorker(const std::vector<std::string> &sources, const std::string &destDir, Mode mode, QObject *parent = nullptr);
 
+	// Turns SIGBUS on a truncated mmap'ed source into a read error.
+	// Call once at startup, before any worker thread exists.
+	static void installSigbusHandler();
+
 	void pause();
 	void resume();
 	void cancel();
@@ -82,7 +106,8 @@ signals:
 	void finished();
 	void errorOccurred(FileError error);
 	void conflictNeeded(QString src, QString dest, QString suggestedName);
-	void fileCompleted(QString path, QString srcHash, QString destHash, bool isTopLevel);
+	void fileCompleted(QString path, QString srcHash, QString destHash, bool isTopLevel, QString note = "");
+	void jobNote(QString note); // Job-level information for the history (e.g. the tuned buffer size)
 
 protected:
 	void run() override;
@@ -105,24 +130,164 @@ private:
 	ConflictAction m_savedAction = Replace;
 	QString m_userNewName;
 
+	// Speed sampling, shared by the pool workers (guarded by m_progressMutex)
+	QMutex m_progressMutex;
 	std::chrono::steady_clock::time_point m_overallStartTime;
+	std::chrono::steady_clock::time_point m_pauseStart;
 	std::chrono::duration<double> m_totalPausedDuration{0};
 	uintmax_t m_totalWorkBytes = 0; // (Size of all files * 2)
-	uintmax_t m_totalBytesProcessed = 0; // Global counter
+	std::atomic<uintmax_t> m_totalBytesProcessed{0}; // Global counter (updated by the parallel copy threads too)
 	std::chrono::steady_clock::time_point m_lastSampleTime;
 	uintmax_t m_lastTotalBytesProcessed = 0;
-	uintmax_t m_unflushedBytes = 0; // Track bytes written since last sync
+	std::atomic<uintmax_t> m_unflushedBytes{0}; // Track bytes written since last sync
+
+	// Job-level space reservation (RESERVE_JOB_SPACE)
+	QMutex m_reservationMutex;
+	int m_reservationFd = -1;
+	std::string m_reservationPath;
+	uintmax_t m_reservedBytes = 0;
+	std::atomic<bool> m_diskFull{false}; // Preallocation failed with ENOSPC, stop the job
+
+	// Copied file whose verification and completion are still to do.
+	// Small files wait in a group, so one syncfs() covers all of them (see commitGroup).
+	struct PendingFile {
+		std::filesystem::path src;
+		std::filesystem::path dest;
+		uintmax_t size = 0;
+		Hasher::Digest srcHash;
+		bool hashed = false; // srcHash is valid and the file must be verified
+		bool isTopLevel = false;
+		bool background = false; // Verify on the verifier thread (not sharing a spinning disk)
+		QString note; // How the file was transferred (e.g. reflink), shown instead of the hashes
+		std::vector<uint64_t> blockHashes; // Source hash per block, for sampling or the hash tree
+		bool hashTree = false; // blockHashes form a hash tree (HASH_TREE) and srcHash is its root
+		bool sampled = false; // Verified by sampling blockHashes (SAMPLED_VERIFY)
+		Hasher::Digest fileHash; // Checksum of the whole source for the manifest (srcHash may be the tree root)
+		bool cacheSource = false; // Record fileHash in the hash cache once the copy is verified
+		struct stat srcStat = {}; // Source before it was read, for the hash cache
+		bool srcHashCached = false; // srcHash came from the hash cache, the source wasn't read
+	};
+
+	// Buffers and io_uring instance of one copying thread.
+	// Each pool worker has its own, so no engine state is shared between files.
+	struct IoContext {
+		// Aligned buffers shared by all copy engines
+		std::unique_ptr<BufferRing> ring;
+		// Kernel-side async I/O, when available.
+		// Declared after ring: it uses the ring's buffers and must be destroyed first.
+		std::unique_ptr<UringEngine> uring;
+		// HDD_WINDOW_MB buffer for copies within one spinning disk, allocated on first use
+		std::unique_ptr<BufferRing> window;
+		// Small files of this thread waiting for the group commit
+		std::vector<PendingFile> pending;
+		uintmax_t pendingBytes = 0;
+	};
+
+	// Allocated per job. The first one is used by the serial loop and pool worker 0.
+	std::vector<std::unique_ptr<IoContext>> m_io;
+
+	// Keeps the pool from running two files on the same spinning disk
+	IoScheduler m_scheduler;
+
+	// Chooses the chunk size per device pair (BUFFER_AUTOTUNE), created per job
+	std::unique_ptr<BufferTuner> m_tuner;
+
+	// HASH_ALGORITHM when the job started, so a change in the settings can't mix algorithms
+	Config::HashAlgorithm m_hashAlgorithm = Config::Defaults::HASH_ALGORITHM;
+
+	// Hash manifest of the job (WRITE_HASH_MANIFEST), written as files are finalized
+	HashManifest m_manifest;
+
+	// Source hashes of earlier jobs (HASH_CACHE), created per job
+	std::unique_ptr<HashCache> m_hashCache;
+	std::atomic<int> m_cacheHits{0};
+
+	// Background verification (ASYNC_VERIFY): reads file N back from the destination
+	// while file N+1 is being copied. Runs for the whole job with its own buffers.
+	std::thread m_verifyThread;
+	std::unique_ptr<IoContext> m_verifyIo;
+	std::deque<PendingFile> m_verifyQueue;
+	QMutex m_verifyMutex;
+	QWaitCondition m_verifyCond;
+	bool m_verifyClosed = false; // No more files will be queued
 
 	struct CopyTask {
 		std::filesystem::path src;
 		std::filesystem::path dest;
 		bool isTopLevel = false;
+		bool sameDevice = false; // Source is on the destination filesystem (Move can rename)
+		bool renamed = false; // Already moved by rename during the scan
+	};
+
+	// Regular file handed to the pool, after its conflict was resolved
+	struct FileJob {
+		CopyTask task;
+		uintmax_t size = 0;
+	};
+
+	// State of the file being copied, shared by the copy engines
+	struct FileTransfer {
+		std::filesystem::path src;
+		std::filesystem::path dest;
+		int fd_in = -1;
+		int fd_out = -1;
+		IoContext *io = nullptr; // Buffers of the thread copying this file
+		qint64 fileSize = 0;
+		qint64 totalRead = 0; // Bytes that reached the destination
+		std::unique_ptr<ChunkHasher> hasher; // Null when checksums are disabled
+		bool directWrite = false; // fd_out has O_DIRECT set
+		bool needsTruncate = false; // ftruncate() to fileSize after the copy (padded O_DIRECT tail, trailing hole)
+		qint64 writebackStarted = 0; // End of the last range handed to writeback (WRITEBACK_WINDOW_MB)
+		qint64 writebackWaited = 0; // End of the last range known to be on disk
 	};
 
 	// Buffer size: 1MB is a good balance for modern NVMe
 	const size_t BUFFER_SIZE = Config::BUFFER_SIZE;
 
-	bool copyFile(const std::filesystem::path &src, const std::filesystem::path &dest, char *buffer, size_t bufferSize, bool isTopLevel, bool isLastFile, FileSystemType fsType);
-	bool verifyFile(const std::filesystem::path &src, const std::filesystem::path &dest, int fd_dest, uint64_t expectedHash, uint64_t &diskHash, char *buffer, size_t bufferSize, bool isLastFile);
+	void orderByPhysicalLocation(std::vector<CopyTask> &tasks);
+	std::unique_ptr<IoContext> createIoContext(size_t ringDepth);
+	void runFilePool(std::vector<FileJob> &jobs, int &processed, int totalFiles, FileSystemType fsType);
+	bool copyFile(const std::filesystem::path &src, const std::filesystem::path &dest, IoContext &io, bool isTopLevel, bool isLastFile, FileSystemType fsType);
+	void commitGroup(IoContext &io, bool isLastGroup);
+	bool finalizeFile(const PendingFile &file, bool checksumFailed, const Hasher::Digest &diskHash, const QString &detail = QString());
+	void cacheSourceHash(const PendingFile &file);
+	void openHashCache();
+	void closeHashCache();
+	void runCompare();
+	bool hashForCompare(const std::filesystem::path &path, const std::filesystem::path &shown, char *buffer, size_t bufferSize, bool useCache, Hasher::Digest &digest);
+	bool verifyAndFinalize(const PendingFile &file, int fd, IoContext &io, bool isLastFile);
+	bool verifySample(const PendingFile &file, int fd, IoContext &io, bool isLastFile);
+	bool checkBlocks(const PendingFile &file, int fd, IoContext &io, const std::vector<uint64_t> &blocks, std::vector<uint64_t> &actual, std::vector<uint64_t> &badBlocks, bool countProgress);
+	bool verifyTree(const PendingFile &file, int fd, IoContext &io, bool isLastFile, Hasher::Digest &diskHash, std::vector<uint64_t> &badBlocks, QString &badRanges);
+	QString describeBlocks(const PendingFile &file, const std::vector<uint64_t> &blocks);
+	bool repairFile(const PendingFile &file, int fd, IoContext &io, std::vector<uint64_t> badBlocks, uint64_t &repaired);
+	static bool useSampling(uintmax_t size);
+	static uint64_t sampledBlocks(uintmax_t size);
+	static uintmax_t workBytes(uintmax_t size);
+	void startVerifier(size_t ringDepth);
+	void queueVerification(PendingFile file);
+	void stopVerifier();
+	void verifierLoop();
+	bool verifyFile(const std::filesystem::path &src, const std::filesystem::path &dest, int fd_dest, const Hasher::Digest &expectedHash, Hasher::Digest &diskHash, IoContext &io, bool isLastFile, bool background = false);
 	void updateProgress(const std::filesystem::path &src, const std::filesystem::path &dest, qint64 totalRead, qint64 fileSize);
+	void copyWithReadWrite(FileTransfer &ft, char *buffer, size_t bufferSize);
+	void copyWithUring(FileTransfer &ft);
+	void copyWithPipeline(FileTransfer &ft);
+	void copyWithParallelChunks(FileTransfer &ft);
+	bool copyWithWindow(FileTransfer &ft);
+	bool copyWithMmap(FileTransfer &ft, size_t chunkSize, bool onlyIfCached);
+	bool copyWithSparse(FileTransfer &ft, char *buffer, size_t bufferSize);
+	bool writeSparseChunk(FileTransfer &ft, const char *data, size_t len, qint64 offset);
+	bool copyWithCopyFileRange(FileTransfer &ft, char *buffer, size_t bufferSize);
+	bool cloneFile(FileTransfer &ft);
+	bool moveFileByRename(const CopyTask &task, uintmax_t fileSize, bool replace);
+	void onBytesCopied(FileTransfer &ft, size_t bytes);
+	void onHoleSkipped(FileTransfer &ft, size_t bytes);
+	void rollWriteback(FileTransfer &ft);
+	bool writeChunk(FileTransfer &ft, char *data, size_t len);
+	bool reserveJobSpace(uintmax_t bytes);
+	void shrinkJobSpace(uintmax_t bytes);
+	void releaseJobSpace();
+	void waitIfPaused();
+	std::chrono::duration<double> pausedTime();
 };
@@ -43,6 +43,10 @@ void DetailsWindow::setSourceDest(const QString &source, const QString &dest) {
 	m_destFolder = dest;
 }
 
+void DetailsWindow::setJobDetails(const QStringList &details) {
+	m_jobDetails = details;
+}
+
 void DetailsWindow::clearHistory() {
 	if (m_treeWidget)
 		m_treeWidget->clear();
@@ -78,9 +82,15 @@ void DetailsWindow::addHistoryEntry(const QString &timestamp, const QString &mod
 	destRoot->setFont(0, QFont("Arial", 10, QFont::Bold));
 	destRoot->setIcon(0, m_treeWidget->style()->standardIcon(QStyle::SP_DirIcon));
 
+	for (const QString &detail : m_jobDetails) {
+		QTreeWidgetItem *detailItem = new QTreeWidgetItem(jobItem);
+		detailItem->setText(0, detail);
+		detailItem->setIcon(0, m_treeWidget->style()->standardIcon(QStyle::SP_MessageBoxInformation));
+	}
+
 	// Add File items
 	for (const auto &entry : entries) {
-		addPathToTree(m_treeWidget, jobItem, entry.path, entry.error, entry.srcHash, entry.destHash);
+		addPathToTree(m_treeWidget, jobItem, entry.path, entry.error, entry.srcHash, entry.destHash, entry.note);
 	}
 
 	m_treeWidget->insertTopLevelItem(0, jobItem);
@@ -127,7 +137,7 @@ void DetailsWindow::populateErrorTree(QTreeWidget *tree, const QList<HistoryEntr
 
 	for (const auto &entry : entries) {
 		if (!entry.error.isEmpty()) {
-			addPathToTree(tree, root, entry.path, entry.error, entry.srcHash, entry.destHash);
+			addPathToTree(tree, root, entry.path, entry.error, entry.srcHash, entry.destHash, entry.note);
 		}
 	}
 
@@ -141,7 +151,7 @@ QString DetailsWindow::getHistoryPath() const {
 	return dir + "/history.json";
 }
 
-void DetailsWindow::addPathToTree(QTreeWidget *tree, QTreeWidgetItem *parent, const QString &fullPath, const QString &error, const QString &srcHash, const QString &destHash) {
+void DetailsWindow::addPathToTree(QTreeWidget *tree, QTreeWidgetItem *parent, const QString &fullPath, const QString &error, const QString &srcHash, const QString &destHash, const QString &note) {
 	if (!tree)
 		return;
 
@@ -181,7 +191,8 @@ void DetailsWindow::addPathToTree(QTreeWidget *tree, QTreeWidgetItem *parent, co
 			errItem->setIcon(0, tree->style()->standardIcon(QStyle::SP_MessageBoxWarning));
 			current->setExpanded(true);
 		} else if (i == parts.size() - 1) {
-			current->setText(1, srcHash);
+			// Show the note in the hash column when the file was not hashed
+			current->setText(1, srcHash.isEmpty() ? note : srcHash);
 			current->setText(2, destHash);
 		}
 	}
@@ -209,6 +220,8 @@ void DetailsWindow::saveHistoryEntry(const QString &timestamp, const QString &mo
 	jobObj["mode"] = mode;
 	jobObj["sourceRoot"] = m_sourceFolder;
 	jobObj["destRoot"] = m_destFolder;
+	if (!m_jobDetails.isEmpty())
+		jobObj["details"] = QJsonArray::fromStringList(m_jobDetails);
 
 	QJsonArray filesArray;
 	for (const auto &e : entries) {
@@ -217,6 +230,8 @@ void DetailsWindow::saveHistoryEntry(const QString &timestamp, const QString &mo
 		fObj["error"] = e.error;
 		fObj["srcHash"] = e.srcHash;
 		fObj["destHash"] = e.destHash;
+		if (!e.note.isEmpty())
+			fObj["note"] = e.note;
 		filesArray.append(fObj);
 	}
 	jobObj["entries"] = filesArray;
@@ -245,13 +260,20 @@ void DetailsWindow::loadHistory() {
 			entries.append({fObj["path"].toString(),
 				fObj["error"].toString(),
 				fObj["srcHash"].toString(),
-				fObj["destHash"].toString()});
+				fObj["destHash"].toString(),
+				fObj["note"].toString()});
 		}
 
 		// Convert temporary QString to a const reference for setSourceDest
 		const QString sourceRoot = job["sourceRoot"].toString();
 		const QString destRoot = job["destRoot"].toString();
 		setSourceDest(sourceRoot, destRoot);
+
+		QStringList details;
+		for (const QJsonValue &detail : job["details"].toArray()) {
+			details.append(detail.toString());
+		}
+		setJobDetails(details);
 		addHistoryEntry(job["time"].toString(), job["mode"].toString(), entries, false);
 	}
 }
@@ -14,6 +14,7 @@ struct HistoryEntry {
 	QString error;
 	QString srcHash;
 	QString destHash;
+	QString note; // How the file was transferred when there is no hash (e.g. reflink clone)
 };
 
 class DetailsWindow : public QObject {
@@ -22,6 +23,7 @@ public:
 	explicit DetailsWindow(QTreeWidget *treeWidget, QObject *parent = nullptr);
 
 	void setSourceDest(const QString &source, const QString &dest);
+	void setJobDetails(const QStringList &details);
 	void addHistoryEntry(const QString &timestamp, const QString &mode, const QList<HistoryEntry> &entries, bool saveToFile = true);
 	void loadHistory();
 	void populateErrorTree(QTreeWidget *tree, const QList<HistoryEntry> &entries);
@@ -33,9 +35,10 @@ public slots:
 private:
 	QString m_sourceFolder;
 	QString m_destFolder;
+	QStringList m_jobDetails; // Job-level notes (e.g. tuned buffer size)
 	QTreeWidget *m_treeWidget;
 
 	QString getHistoryPath() const;
-	void addPathToTree(QTreeWidget *tree, QTreeWidgetItem *parent, const QString &fullPath, const QString &error, const QString &srcHash, const QString &destHash);
+	void addPathToTree(QTreeWidget *tree, QTreeWidgetItem *parent, const QString &fullPath, const QString &error, const QString &srcHash, const QString &destHash, const QString &note = "");
 	void saveHistoryEntry(const QString &timestamp, const QString &mode, const QList<HistoryEntry> &entries);
 };
@@ -0,0 +1,263 @@
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/xattr.h>
+#include <unistd.h>
+#include <vector>
+#include <xxhash.h>
+
+#include "HashCache.h"
+#include "HashManifest.h"
+#include "LogHelper.h"
+
+namespace {
+
+constexpr char INDEX_MAGIC[8] = {'M', 'V', 'H', 'C', 'A', 'C', 'H', 'E'};
+constexpr uint32_t INDEX_VERSION = 1;
+
+// Layout of the xattr value: version, digest size, 6 reserved bytes, file size,
+// mtime in nanoseconds and inode number (8 bytes each), then the digest.
+// Version 1 had no inode number and is ignored.
+constexpr uint8_t XATTR_VERSION = 2;
+constexpr size_t XATTR_HEADER = 32;
+
+int64_t mtimeNs(const struct stat &st) {
+	return (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+}
+
+int64_t ctimeNs(const struct stat &st) {
+	return (int64_t)st.st_ctim.tv_sec * 1000000000 + st.st_ctim.tv_nsec;
+}
+
+// "user.movero.xxh3"
+std::string xattrName(Config::HashAlgorithm algorithm) {
+	return std::string("user.movero.") + HashManifest::extension(algorithm);
+}
+
+} // namespace
+
+HashCache::~HashCache() {
+	close();
+}
+
+bool HashCache::openIndex(const std::string &indexPath) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	unmapIndex();
+
+	m_fd = ::open(indexPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+	if (m_fd < 0) {
+		LOG(LogLevel::WARNING) << "Hash cache index unavailable:" << indexPath.c_str() << strerror(errno);
+		return false;
+	}
+	// One writer at a time. The lock goes away with the descriptor, also on a crash.
+	if (flock(m_fd, LOCK_EX | LOCK_NB) != 0) {
+		LOG(LogLevel::INFO) << "Hash cache index in use by another process, using xattrs only.";
+		::close(m_fd);
+		m_fd = -1;
+		return false;
+	}
+
+	struct stat st;
+	Header header{};
+	bool valid = fstat(m_fd, &st) == 0 && (size_t)st.st_size >= sizeof(Header) &&
+				 pread(m_fd, &header, sizeof(header), 0) == (ssize_t)sizeof(header) &&
+				 std::memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0 &&
+				 header.version == INDEX_VERSION && header.recordSize == sizeof(Record) &&
+				 header.capacity >= INITIAL_CAPACITY && header.capacity <= MAX_CAPACITY &&
+				 (header.capacity & (header.capacity - 1)) == 0 &&
+				 (uint64_t)st.st_size == sizeof(Header) + header.capacity * sizeof(Record);
+
+	// A new, foreign or damaged index is simply started over
+	if (!mapIndex(valid ? header.capacity : INITIAL_CAPACITY, !valid)) {
+		::close(m_fd);
+		m_fd = -1;
+		return false;
+	}
+	LOG(LogLevel::INFO) << "Hash cache index:" << indexPath.c_str() << "Entries:" << m_header->count;
+	return true;
+}
+
+void HashCache::close() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	unmapIndex();
+	if (m_fd >= 0) {
+		::close(m_fd);
+		m_fd = -1;
+	}
+}
+
+// Maps the index with room for 'capacity' records. 'initialize' empties it first.
+bool HashCache::mapIndex(uint64_t capacity, bool initialize) {
+	size_t size = sizeof(Header) + capacity * sizeof(Record);
+	// Truncating to 0 first zeroes every record
+	if (initialize && ftruncate(m_fd, 0) != 0)
+		return false;
+	if (ftruncate(m_fd, size) != 0) {
+		LOG(LogLevel::WARNING) << "Cannot resize the hash cache index:" << strerror(errno);
+		return false;
+	}
+
+	void *map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+	if (map == MAP_FAILED) {
+		LOG(LogLevel::WARNING) << "Cannot map the hash cache index:" << strerror(errno);
+		return false;
+	}
+	m_mapSize = size;
+	m_header = static_cast<Header *>(map);
+	m_records = reinterpret_cast<Record *>(static_cast<char *>(map) + sizeof(Header));
+
+	if (initialize) {
+		std::memcpy(m_header->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+		m_header->version = INDEX_VERSION;
+		m_header->recordSize = sizeof(Record);
+		m_header->capacity = capacity;
+		m_header->count = 0;
+	}
+	return true;
+}
+
+void HashCache::unmapIndex() {
+	if (m_header) {
+		munmap(m_header, m_mapSize);
+	}
+	m_header = nullptr;
+	m_records = nullptr;
+	m_mapSize = 0;
+}
+
+uint64_t HashCache::recordCheck(const Record &record) {
+	Record copy = record;
+	copy.check = 0;
+	return XXH3_64bits(&copy, sizeof(copy));
+}
+
+HashCache::Record *HashCache::findSlot(uint64_t dev, uint64_t ino, uint8_t algorithm) {
+	uint64_t key[3] = {dev, ino, algorithm};
+	uint64_t mask = m_header->capacity - 1;
+	uint64_t slot = XXH3_64bits(key, sizeof(key)) & mask;
+
+	// Linear probing. The table is never more than 3/4 full, so an empty slot always ends it.
+	while (true) {
+		Record &record = m_records[slot];
+		if (!record.used || (record.dev == dev && record.ino == ino && record.algorithm == algorithm))
+			return &record;
+		slot = (slot + 1) & mask;
+	}
+}
+
+// Doubles the table. The used records are taken out and inserted again.
+bool HashCache::grow() {
+	uint64_t capacity = m_header->capacity;
+	std::vector<Record> records;
+	if (capacity < MAX_CAPACITY) {
+		records.reserve(m_header->count);
+		for (uint64_t i = 0; i < capacity; ++i) {
+			if (m_records[i].used)
+				records.push_back(m_records[i]);
+		}
+		capacity *= 2;
+	}
+
+	unmapIndex();
+	if (!mapIndex(capacity, true)) {
+		::close(m_fd);
+		m_fd = -1;
+		return false;
+	}
+
+	for (const Record &record : records) {
+		*findSlot(record.dev, record.ino, record.algorithm) = record;
+	}
+	m_header->count = records.size();
+	LOG(LogLevel::DEBUG) << "Hash cache index resized to" << capacity << "records";
+	return true;
+}
+
+bool HashCache::lookup(int fd, const struct stat &st, Config::HashAlgorithm algorithm, Hasher::Digest &digest) {
+	uint8_t value[XATTR_HEADER + Hasher::Digest::MAX_SIZE];
+	ssize_t len = fgetxattr(fd, xattrName(algorithm).c_str(), value, sizeof(value));
+	if (len >= (ssize_t)XATTR_HEADER && value[0] == XATTR_VERSION && len == (ssize_t)(XATTR_HEADER + value[1])) {
+		uint64_t size, ino;
+		int64_t mtime;
+		std::memcpy(&size, value + 8, sizeof(size));
+		std::memcpy(&mtime, value + 16, sizeof(mtime));
+		std::memcpy(&ino, value + 24, sizeof(ino));
+		// A different inode: the attribute was copied along with the file (cp -a, rsync -X, tar --xattrs)
+		if (size == (uint64_t)st.st_size && mtime == mtimeNs(st) && ino == (uint64_t)st.st_ino &&
+			value[1] <= Hasher::Digest::MAX_SIZE) {
+			digest.size = value[1];
+			std::memcpy(digest.bytes, value + XATTR_HEADER, digest.size);
+			return true;
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return lookupIndex(st, algorithm, digest);
+}
+
+void HashCache::store(int fd, const struct stat &st, Config::HashAlgorithm algorithm, const Hasher::Digest &digest) {
+	uint8_t value[XATTR_HEADER + Hasher::Digest::MAX_SIZE] = {};
+	value[0] = XATTR_VERSION;
+	value[1] = static_cast<uint8_t>(digest.size);
+	uint64_t size = st.st_size;
+	int64_t mtime = mtimeNs(st);
+	uint64_t ino = st.st_ino;
+	std::memcpy(value + 8, &size, sizeof(size));
+	std::memcpy(value + 16, &mtime, sizeof(mtime));
+	std::memcpy(value + 24, &ino, sizeof(ino));
+	std::memcpy(value + XATTR_HEADER, digest.bytes, digest.size);
+
+	if (fsetxattr(fd, xattrName(algorithm).c_str(), value, XATTR_HEADER + digest.size, 0) == 0)
+		return;
+
+	// ENOTSUP, EROFS, EPERM, EACCES, EDQUOT: keep it in the index instead
+	std::lock_guard<std::mutex> lock(m_mutex);
+	storeIndex(st, algorithm, digest);
+}
+
+bool HashCache::lookupIndex(const struct stat &st, Config::HashAlgorithm algorithm, Hasher::Digest &digest) {
+	if (!m_header)
+		return false;
+
+	const Record &record = *findSlot(st.st_dev, st.st_ino, static_cast<uint8_t>(algorithm));
+	if (!record.used || record.check != recordCheck(record) || record.digestSize > Hasher::Digest::MAX_SIZE)
+		return false;
+	if (record.size != (uint64_t)st.st_size || record.mtimeNs != mtimeNs(st) || record.ctimeNs != ctimeNs(st))
+		return false;
+
+	digest.size = record.digestSize;
+	std::memcpy(digest.bytes, record.digest, digest.size);
+	return true;
+}
+
+void HashCache::storeIndex(const struct stat &st, Config::HashAlgorithm algorithm, const Hasher::Digest &digest) {
+	if (!m_header)
+		return;
+
+	Record *slot = findSlot(st.st_dev, st.st_ino, static_cast<uint8_t>(algorithm));
+	if (!slot->used) {
+		if ((m_header->count + 1) * 4 > m_header->capacity * 3) {
+			if (!grow())
+				return;
+			slot = findSlot(st.st_dev, st.st_ino, static_cast<uint8_t>(algorithm));
+		}
+		m_header->count++;
+	}
+
+	// An older entry of the same inode (the file changed or the inode was reused) is replaced
+	Record record{};
+	record.dev = st.st_dev;
+	record.ino = st.st_ino;
+	record.size = st.st_size;
+	record.mtimeNs = mtimeNs(st);
+	record.ctimeNs = ctimeNs(st);
+	record.algorithm = static_cast<uint8_t>(algorithm);
+	record.digestSize = static_cast<uint8_t>(digest.size);
+	record.used = 1;
+	std::memcpy(record.digest, digest.bytes, digest.size);
+	record.check = recordCheck(record);
+	*slot = record;
+}
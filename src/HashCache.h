@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <sys/stat.h>
+
+#include "Config.h"
+#include "Hasher.h"
+
+// Remembers the checksum of unchanged source files between jobs, so copying the same library
+// to several disks hashes it once. A file counts as unchanged while its inode, size and mtime
+// (and, in the index, device and ctime) are the same as when it was hashed.
+//
+// The hash is kept in a "user.movero.<algorithm>" extended attribute of the file itself,
+// which follows the file on renames. The xattr can't include the ctime, since writing it
+// changes the ctime, so a file rewritten in place with its mtime put back keeps a stale
+// entry. A copy that doesn't match a cached hash is therefore only failed after the source
+// was hashed again (see CopyWorker::verifyAndFinalize).
+// Where xattrs can't be written (read-only media, FAT, NTFS-3G, files of other users) it
+// goes to a memory-mapped index file: an open-addressing table of fixed 88-byte records with
+// a checksum each, so a record torn by a crash is ignored.
+//
+// Thread safe: the pool workers share one cache.
+class HashCache {
+public:
+	HashCache() = default;
+	~HashCache();
+
+	HashCache(const HashCache &) = delete;
+	HashCache &operator=(const HashCache &) = delete;
+
+	// Opens (or creates) the index at 'indexPath'. Without it only xattrs are used, e.g. when
+	// another Movero process holds the index.
+	bool openIndex(const std::string &indexPath);
+	void close();
+
+	// Cached hash of the open file 'fd' with 'st' from fstat(). False if unknown or outdated.
+	bool lookup(int fd, const struct stat &st, Config::HashAlgorithm algorithm, Hasher::Digest &digest);
+
+	// Records the hash of the open file 'fd'. 'st' must be the fstat() taken before the
+	// data was read, so a change during the read leaves an entry that never matches.
+	void store(int fd, const struct stat &st, Config::HashAlgorithm algorithm, const Hasher::Digest &digest);
+
+private:
+	struct Header {
+		char magic[8];
+		uint32_t version;
+		uint32_t recordSize;
+		uint64_t capacity; // Records, a power of two
+		uint64_t count; // Used records
+	};
+
+	struct Record {
+		uint64_t dev;
+		uint64_t ino;
+		uint64_t size;
+		int64_t mtimeNs;
+		int64_t ctimeNs;
+		uint64_t check; // XXH3 of the rest of the record
+		uint8_t algorithm;
+		uint8_t digestSize;
+		uint8_t used;
+		uint8_t reserved[5];
+		uint8_t digest[Hasher::Digest::MAX_SIZE];
+	};
+	static_assert(sizeof(Record) == 88, "The record size is part of the index format");
+
+	static constexpr uint64_t INITIAL_CAPACITY = 4096;
+	// 4M files, 352 MB. A full index is cleared and starts over.
+	static constexpr uint64_t MAX_CAPACITY = uint64_t(1) << 22;
+
+	int m_fd = -1;
+	Header *m_header = nullptr;
+	Record *m_records = nullptr;
+	size_t m_mapSize = 0;
+	std::mutex m_mutex;
+
+	static uint64_t recordCheck(const Record &record);
+	bool mapIndex(uint64_t capacity, bool initialize);
+	void unmapIndex();
+	// Slot of the entry for (dev, ino, algorithm), or the empty slot where it goes
+	Record *findSlot(uint64_t dev, uint64_t ino, uint8_t algorithm);
+	bool grow();
+
+	bool lookupIndex(const struct stat &st, Config::HashAlgorithm algorithm, Hasher::Digest &digest);
+	void storeIndex(const struct stat &st, Config::HashAlgorithm algorithm, const Hasher::Digest &digest);
+};
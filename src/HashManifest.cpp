@@ -0,0 +1,324 @@
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <memory>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "HashManifest.h"
+#include "IoScheduler.h"
+#include "LogHelper.h"
+
+namespace fs = std::filesystem;
+
+// coreutils convention: a name with a backslash or line break is written escaped,
+// and its line starts with a backslash. Returns the name unchanged otherwise.
+static std::string escapeName(const std::string &name, bool &escaped) {
+	escaped = name.find_first_of("\\\n\r") != std::string::npos;
+	if (!escaped)
+		return name;
+
+	std::string text;
+	text.reserve(name.size() + 8);
+	for (char c : name) {
+		if (c == '\\') {
+			text += "\\\\";
+		} else if (c == '\n') {
+			text += "\\n";
+		} else if (c == '\r') {
+			text += "\\r";
+		} else {
+			text += c;
+		}
+	}
+	return text;
+}
+
+HashManifest::~HashManifest() {
+	close();
+}
+
+bool HashManifest::open(const fs::path &path, Config::HashAlgorithm algorithm) {
+	close();
+	m_file = std::fopen(path.c_str(), "we"); // "e": O_CLOEXEC
+	if (!m_file) {
+		LOG(LogLevel::ERROR) << "Cannot create hash manifest:" << path.c_str() << strerror(errno);
+		return false;
+	}
+	m_path = path;
+	m_algorithm = algorithm;
+	m_failed = false;
+	return true;
+}
+
+void HashManifest::add(const fs::path &relativePath, const Hasher::Digest &digest) {
+	bool escaped;
+	std::string name = escapeName(relativePath.generic_string(), escaped);
+
+	std::string line;
+	line.reserve(name.size() + digest.size * 2 + 8);
+	if (escaped)
+		line += '\\';
+	if (m_algorithm == Config::HashAlgorithm::XXH3_64)
+		line += "XXH3_";
+	line += digest.hex();
+	line += "  ";
+	line += name;
+	line += '\n';
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!m_file)
+		return;
+	if (std::fwrite(line.data(), 1, line.size(), m_file) != line.size() && !m_failed) {
+		LOG(LogLevel::ERROR) << "Cannot write hash manifest:" << m_path.c_str() << strerror(errno);
+		m_failed = true;
+	}
+}
+
+bool HashManifest::close() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!m_file)
+		return !m_failed;
+
+	// The manifest is only worth something if it survives a power cut like the files it lists
+	bool ok = std::fflush(m_file) == 0 && fdatasync(fileno(m_file)) == 0;
+	ok = (std::fclose(m_file) == 0) && ok;
+	m_file = nullptr;
+	if (!ok && !m_failed) {
+		LOG(LogLevel::ERROR) << "Cannot write hash manifest:" << m_path.c_str() << strerror(errno);
+	}
+	m_failed = m_failed || !ok;
+	return !m_failed;
+}
+
+const char *HashManifest::extension(Config::HashAlgorithm algorithm) {
+	switch (algorithm) {
+	case Config::HashAlgorithm::XXH64:
+		return "xxh64";
+	case Config::HashAlgorithm::XXH3_64:
+		return "xxh3";
+	case Config::HashAlgorithm::XXH3_128:
+		return "xxh128";
+	case Config::HashAlgorithm::CRC32C:
+		return "crc32c";
+	case Config::HashAlgorithm::BLAKE3:
+		return "b3";
+	}
+	return "txt";
+}
+
+// Hash lengths: 8 hex digits are CRC32C (Movero doesn't compute xxhsum's XXH32),
+// 16 XXH64 ("XXH3_" + 16 for XXH3-64), 32 XXH3-128 and 64 BLAKE3.
+// Accepts both "<hash>  <name>" and the binary mode form "<hash> *<name>".
+bool HashManifest::parseLine(const std::string &line, Entry &entry) {
+	size_t pos = 0;
+	bool escaped = !line.empty() && line[0] == '\\';
+	if (escaped)
+		pos = 1;
+
+	size_t space = line.find(' ', pos);
+	if (space == std::string::npos || space + 2 > line.size() || (line[space + 1] != ' ' && line[space + 1] != '*'))
+		return false;
+
+	std::string hash = line.substr(pos, space - pos);
+	bool xxh3 = hash.compare(0, 5, "XXH3_") == 0;
+	if (xxh3)
+		hash.erase(0, 5);
+
+	for (char &c : hash) {
+		if (!std::isxdigit(static_cast<unsigned char>(c)))
+			return false;
+		c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+	}
+
+	if (xxh3 && hash.size() == 16) {
+		entry.algorithm = Config::HashAlgorithm::XXH3_64;
+	} else if (xxh3) {
+		return false;
+	} else if (hash.size() == 8) {
+		entry.algorithm = Config::HashAlgorithm::CRC32C;
+	} else if (hash.size() == 16) {
+		entry.algorithm = Config::HashAlgorithm::XXH64;
+	} else if (hash.size() == 32) {
+		entry.algorithm = Config::HashAlgorithm::XXH3_128;
+	} else if (hash.size() == 64) {
+		entry.algorithm = Config::HashAlgorithm::BLAKE3;
+	} else {
+		return false;
+	}
+	entry.hash = std::move(hash);
+
+	std::string name = line.substr(space + 2);
+	if (escaped) {
+		std::string plain;
+		plain.reserve(name.size());
+		for (size_t i = 0; i < name.size(); ++i) {
+			if (name[i] != '\\') {
+				plain += name[i];
+				continue;
+			}
+			if (++i == name.size())
+				return false;
+			if (name[i] == '\\') {
+				plain += '\\';
+			} else if (name[i] == 'n') {
+				plain += '\n';
+			} else if (name[i] == 'r') {
+				plain += '\r';
+			} else {
+				return false;
+			}
+		}
+		name.swap(plain);
+	}
+	if (name.empty())
+		return false;
+
+	entry.path = std::move(name);
+	return true;
+}
+
+bool HashManifest::hashFile(const fs::path &path, Config::HashAlgorithm algorithm,
+							char *buffer, size_t bufferSize, Hasher::Digest &digest) {
+	int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return false;
+
+	// Drop the cached pages first, a scrub must read what is actually on the disk
+	posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+	posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+	std::unique_ptr<Hasher> hasher = Hasher::create(algorithm);
+	bool ok = true;
+	while (true) {
+		ssize_t n = ::read(fd, buffer, bufferSize);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n < 0) {
+			LOG(LogLevel::ERROR) << "Read error:" << path.c_str() << strerror(errno);
+			ok = false;
+			break;
+		}
+		if (n == 0)
+			break;
+		hasher->update(buffer, n);
+	}
+
+	// Don't leave the archive in the page cache either
+	posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+	::close(fd);
+
+	if (ok)
+		digest = hasher->digest();
+	return ok;
+}
+
+HashManifest::VerifyResult HashManifest::verify(const fs::path &manifest, int threads, size_t bufferSize, std::ostream &out) {
+	VerifyResult result;
+	std::ifstream in(manifest);
+	if (!in) {
+		LOG(LogLevel::ERROR) << "Cannot open hash manifest:" << manifest.c_str() << strerror(errno);
+		return result;
+	}
+	result.opened = true;
+
+	const fs::path base = manifest.has_parent_path() ? manifest.parent_path() : fs::path(".");
+
+	// Several files at a time keep an SSD busy, but make a spinning disk seek between them
+	struct stat st;
+	IoScheduler scheduler;
+	if (stat(base.c_str(), &st) == 0 && scheduler.isRotational(st.st_dev)) {
+		threads = 1;
+	}
+	threads = std::max(threads, 1);
+	bufferSize = std::max<size_t>(bufferSize, 64 * 1024);
+
+	LOG(LogLevel::INFO) << "Verifying" << manifest.c_str() << "with" << threads << "threads";
+
+	std::mutex inMutex; // Lines are handed out one at a time
+	std::mutex outMutex;
+	uint64_t lineNumber = 0;
+	std::atomic<uint64_t> ok{0}, failed{0}, unreadable{0}, skipped{0};
+
+	// Names are printed the way they are listed, so one file is always one line
+	auto printable = [](const std::string &name) {
+		bool escaped;
+		std::string text = escapeName(name, escaped);
+		return escaped ? "\\" + text : text;
+	};
+
+	auto worker = [&]() {
+		std::vector<char> buffer(bufferSize);
+		std::string line;
+		while (true) {
+			uint64_t number;
+			{
+				std::lock_guard<std::mutex> lock(inMutex);
+				if (!std::getline(in, line))
+					break;
+				number = ++lineNumber;
+			}
+			if (!line.empty() && line.back() == '\r')
+				line.pop_back();
+			if (line.empty())
+				continue;
+
+			Entry entry;
+			if (!parseLine(line, entry)) {
+				skipped++;
+				std::lock_guard<std::mutex> lock(outMutex);
+				out << manifest.string() << ":" << number << ": improperly formatted line" << std::endl;
+				continue;
+			}
+			if (!Hasher::isAvailable(entry.algorithm)) {
+				skipped++;
+				std::lock_guard<std::mutex> lock(outMutex);
+				out << printable(entry.path) << ": SKIPPED (" << Hasher::name(entry.algorithm) << " not supported by this build)" << std::endl;
+				continue;
+			}
+
+			fs::path path(entry.path);
+			if (path.is_relative())
+				path = base / path;
+
+			Hasher::Digest digest;
+			const char *status;
+			if (!hashFile(path, entry.algorithm, buffer.data(), buffer.size(), digest)) {
+				unreadable++;
+				status = "FAILED open or read";
+			} else if (digest.hex() != entry.hash) {
+				failed++;
+				status = "FAILED";
+			} else {
+				ok++;
+				status = "OK";
+			}
+
+			std::lock_guard<std::mutex> lock(outMutex);
+			out << printable(entry.path) << ": " << status << std::endl;
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for (int i = 1; i < threads; ++i) {
+		pool.emplace_back(worker);
+	}
+	worker();
+	for (auto &t : pool) {
+		t.join();
+	}
+
+	result.ok = ok;
+	result.failed = failed;
+	result.unreadable = unreadable;
+	result.skipped = skipped;
+	LOG(LogLevel::INFO) << "Verified" << manifest.c_str() << "OK:" << result.ok << "Failed:" << result.failed
+						<< "Unreadable:" << result.unreadable << "Skipped:" << result.skipped;
+	return result;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+#include "Config.h"
+#include "Hasher.h"
+
+// Checksum list of a job, one "<hash>  <relative path>" line per file, in the format of
+// xxhsum and b3sum (GNU style). XXH3-64 hashes carry xxhsum's "XXH3_" prefix so they can't be
+// mistaken for XXH64. Names with a newline or backslash are escaped like coreutils does.
+// The paths are relative to the directory holding the manifest, so
+// "cd <dest> && xxhsum -c <manifest>" (b3sum --check for BLAKE3) checks the copy as well.
+//
+// Lines are written as files are finalized and read back one at a time, so neither
+// side holds the list in memory, whatever the number of files.
+class HashManifest {
+public:
+	HashManifest() = default;
+	~HashManifest();
+
+	HashManifest(const HashManifest &) = delete;
+	HashManifest &operator=(const HashManifest &) = delete;
+
+	// --- Writer ---
+
+	// Creates the manifest at 'path'. Returns false if it can't be created.
+	bool open(const std::filesystem::path &path, Config::HashAlgorithm algorithm);
+	bool isOpen() const { return m_file != nullptr; }
+	const std::filesystem::path &path() const { return m_path; }
+
+	// Appends one file. Safe to call from several threads.
+	void add(const std::filesystem::path &relativePath, const Hasher::Digest &digest);
+
+	// Flushes the manifest to the disk. Returns false if any write failed.
+	bool close();
+
+	// File extension used by the checksum tools, e.g. "xxh128"
+	static const char *extension(Config::HashAlgorithm algorithm);
+
+	// --- Verification ---
+
+	struct VerifyResult {
+		bool opened = false; // The manifest itself could be read
+		uint64_t ok = 0;
+		uint64_t failed = 0; // Hash differs
+		uint64_t unreadable = 0; // Missing or read error
+		uint64_t skipped = 0; // Malformed line, or an algorithm this build can't compute
+	};
+
+	// Re-hashes every file listed in 'manifest' with 'threads' files at a time (one on a
+	// spinning disk) and prints "<path>: OK" or "<path>: FAILED" per file to 'out', like
+	// xxhsum -c. Relative paths are resolved against the manifest's directory.
+	// The page cache is dropped before each file, so the data really comes from the disk.
+	static VerifyResult verify(const std::filesystem::path &manifest, int threads, size_t bufferSize, std::ostream &out);
+
+private:
+	struct Entry {
+		Config::HashAlgorithm algorithm = Config::HashAlgorithm::XXH64;
+		std::string hash; // Lowercase hex
+		std::string path;
+	};
+
+	// Parses one line of the manifest. The algorithm follows from the hash length and prefix.
+	static bool parseLine(const std::string &line, Entry &entry);
+	// Hashes a whole file. Returns false if it can't be opened or read.
+	static bool hashFile(const std::filesystem::path &path, Config::HashAlgorithm algorithm,
+						 char *buffer, size_t bufferSize, Hasher::Digest &digest);
+
+	std::FILE *m_file = nullptr;
+	std::filesystem::path m_path;
+	Config::HashAlgorithm m_algorithm = Config::Defaults::HASH_ALGORITHM;
+	std::mutex m_mutex;
+	bool m_failed = false; // A write failed
+};
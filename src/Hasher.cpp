@@ -0,0 +1,323 @@
+#include <cstring>
+#include <xxhash.h>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_acle.h>
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+
+#if HAVE_BLAKE3
+#include <blake3.h>
+#endif
+
+#include "Hasher.h"
+
+#if HAVE_AVX2_HASHER
+// HasherAvx2.c
+extern "C" {
+void *moveroXxh3Avx2Create(int wide);
+void moveroXxh3Avx2Free(void *state);
+void moveroXxh3Avx2Update(void *state, int wide, const void *data, size_t len);
+unsigned long long moveroXxh3Avx2Digest64(void *state);
+void moveroXxh3Avx2Digest128(void *state, unsigned char out[16]);
+}
+#endif
+
+Hasher::Digest Hasher::Digest::fromUint64(uint64_t value) {
+	Digest result;
+	result.size = 8;
+	for (int i = 7; i >= 0; --i) {
+		result.bytes[i] = static_cast<uint8_t>(value);
+		value >>= 8;
+	}
+	return result;
+}
+
+Hasher::Digest Hasher::Digest::fromUint32(uint32_t value) {
+	Digest result;
+	result.size = 4;
+	for (int i = 3; i >= 0; --i) {
+		result.bytes[i] = static_cast<uint8_t>(value);
+		value >>= 8;
+	}
+	return result;
+}
+
+std::string Hasher::Digest::hex() const {
+	static const char digits[] = "0123456789abcdef";
+	std::string text;
+	text.reserve(size * 2);
+	for (size_t i = 0; i < size; ++i) {
+		text += digits[bytes[i] >> 4];
+		text += digits[bytes[i] & 0xf];
+	}
+	return text;
+}
+
+bool Hasher::Digest::operator==(const Digest &other) const {
+	return size == other.size && std::memcmp(bytes, other.bytes, size) == 0;
+}
+
+namespace {
+
+class Xxh64Hasher : public Hasher {
+public:
+	Xxh64Hasher() : m_state(XXH64_createState()) { XXH64_reset(m_state, 0); }
+	~Xxh64Hasher() override { XXH64_freeState(m_state); }
+
+	void update(const void *data, size_t len) override { XXH64_update(m_state, data, len); }
+	Digest digest() override { return Digest::fromUint64(XXH64_digest(m_state)); }
+
+private:
+	XXH64_state_t *m_state;
+};
+
+// XXH3 from libxxhash (SSE2 on x86-64, NEON on ARM)
+class Xxh3Hasher : public Hasher {
+public:
+	explicit Xxh3Hasher(bool wide) : m_state(XXH3_createState()), m_wide(wide) {
+		if (m_wide) {
+			XXH3_128bits_reset(m_state);
+		} else {
+			XXH3_64bits_reset(m_state);
+		}
+	}
+	~Xxh3Hasher() override { XXH3_freeState(m_state); }
+
+	void update(const void *data, size_t len) override {
+		if (m_wide) {
+			XXH3_128bits_update(m_state, data, len);
+		} else {
+			XXH3_64bits_update(m_state, data, len);
+		}
+	}
+
+	Digest digest() override {
+		if (!m_wide)
+			return Digest::fromUint64(XXH3_64bits_digest(m_state));
+
+		XXH128_canonical_t canonical;
+		XXH128_canonicalFromHash(&canonical, XXH3_128bits_digest(m_state));
+		Digest result;
+		std::memcpy(result.bytes, canonical.digest, sizeof(canonical.digest));
+		result.size = sizeof(canonical.digest);
+		return result;
+	}
+
+private:
+	XXH3_state_t *m_state;
+	bool m_wide;
+};
+
+// --- CRC32C (Castagnoli), as used by iSCSI, ext4 metadata and btrfs ---
+
+// Reflected polynomial 0x1EDC6F41
+constexpr uint32_t CRC32C_POLY = 0x82F63B78;
+
+struct Crc32cTable {
+	uint32_t entries[256];
+	Crc32cTable() {
+		for (uint32_t i = 0; i < 256; ++i) {
+			uint32_t crc = i;
+			for (int bit = 0; bit < 8; ++bit) {
+				crc = (crc >> 1) ^ ((crc & 1) ? CRC32C_POLY : 0);
+			}
+			entries[i] = crc;
+		}
+	}
+};
+
+uint32_t crc32cTable(uint32_t crc, const uint8_t *p, size_t len) {
+	static const Crc32cTable table;
+	while (len--) {
+		crc = table.entries[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+	}
+	return crc;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2"))) uint32_t crc32cHardware(uint32_t crc, const uint8_t *p, size_t len) {
+	uint64_t crc64 = crc;
+	while (len >= 8) {
+		uint64_t word;
+		std::memcpy(&word, p, 8);
+		crc64 = _mm_crc32_u64(crc64, word);
+		p += 8;
+		len -= 8;
+	}
+	crc = static_cast<uint32_t>(crc64);
+	while (len--) {
+		crc = _mm_crc32_u8(crc, *p++);
+	}
+	return crc;
+}
+
+bool hasCrc32cInstructions() {
+	return __builtin_cpu_supports("sse4.2");
+}
+#elif defined(__aarch64__)
+__attribute__((target("+crc"))) uint32_t crc32cHardware(uint32_t crc, const uint8_t *p, size_t len) {
+	while (len >= 8) {
+		uint64_t word;
+		std::memcpy(&word, p, 8);
+		crc = __crc32cd(crc, word);
+		p += 8;
+		len -= 8;
+	}
+	while (len--) {
+		crc = __crc32cb(crc, *p++);
+	}
+	return crc;
+}
+
+bool hasCrc32cInstructions() {
+	return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+}
+#else
+uint32_t crc32cHardware(uint32_t crc, const uint8_t *p, size_t len) {
+	return crc32cTable(crc, p, len);
+}
+
+bool hasCrc32cInstructions() {
+	return false;
+}
+#endif
+
+class Crc32cHasher : public Hasher {
+public:
+	Crc32cHasher() : m_update(hasCrc32cInstructions() ? crc32cHardware : crc32cTable) {}
+
+	void update(const void *data, size_t len) override {
+		m_crc = m_update(m_crc, static_cast<const uint8_t *>(data), len);
+	}
+	Digest digest() override { return Digest::fromUint32(~m_crc); }
+
+private:
+	uint32_t (*m_update)(uint32_t, const uint8_t *, size_t);
+	uint32_t m_crc = 0xFFFFFFFF;
+};
+
+#if HAVE_BLAKE3
+class Blake3Hasher : public Hasher {
+public:
+	Blake3Hasher() { blake3_hasher_init(&m_state); }
+
+	void update(const void *data, size_t len) override { blake3_hasher_update(&m_state, data, len); }
+	Digest digest() override {
+		Digest result;
+		blake3_hasher_finalize(&m_state, result.bytes, BLAKE3_OUT_LEN);
+		result.size = BLAKE3_OUT_LEN;
+		return result;
+	}
+
+private:
+	blake3_hasher m_state;
+};
+#endif
+
+#if HAVE_AVX2_HASHER
+// XXH3 through the AVX2 build in HasherAvx2.c
+class Xxh3Avx2Hasher : public Hasher {
+public:
+	explicit Xxh3Avx2Hasher(bool wide) : m_state(moveroXxh3Avx2Create(wide)), m_wide(wide) {}
+	~Xxh3Avx2Hasher() override { moveroXxh3Avx2Free(m_state); }
+
+	void update(const void *data, size_t len) override {
+		moveroXxh3Avx2Update(m_state, m_wide, data, len);
+	}
+
+	Digest digest() override {
+		if (!m_wide)
+			return Digest::fromUint64(moveroXxh3Avx2Digest64(m_state));
+
+		Digest result;
+		moveroXxh3Avx2Digest128(m_state, result.bytes);
+		result.size = 16;
+		return result;
+	}
+
+private:
+	void *m_state;
+	bool m_wide;
+};
+#endif
+
+bool hasAvx2() {
+#if HAVE_AVX2_HASHER
+	return __builtin_cpu_supports("avx2");
+#else
+	return false;
+#endif
+}
+
+} // namespace
+
+std::unique_ptr<Hasher> Hasher::create(Config::HashAlgorithm algorithm) {
+	using Config::HashAlgorithm;
+
+	switch (algorithm) {
+		case HashAlgorithm::XXH64:
+			return std::make_unique<Xxh64Hasher>();
+		case HashAlgorithm::CRC32C:
+			return std::make_unique<Crc32cHasher>();
+		case HashAlgorithm::BLAKE3:
+#if HAVE_BLAKE3
+			return std::make_unique<Blake3Hasher>();
+#else
+			break;
+#endif
+		case HashAlgorithm::XXH3_64:
+		case HashAlgorithm::XXH3_128:
+			break;
+	}
+
+	bool wide = (algorithm == HashAlgorithm::XXH3_128);
+#if HAVE_AVX2_HASHER
+	if (hasAvx2())
+		return std::make_unique<Xxh3Avx2Hasher>(wide);
+#endif
+	return std::make_unique<Xxh3Hasher>(wide);
+}
+
+bool Hasher::isAvailable(Config::HashAlgorithm algorithm) {
+#if !HAVE_BLAKE3
+	if (algorithm == Config::HashAlgorithm::BLAKE3)
+		return false;
+#endif
+	(void)algorithm;
+	return true;
+}
+
+const char *Hasher::name(Config::HashAlgorithm algorithm) {
+	switch (algorithm) {
+		case Config::HashAlgorithm::XXH64:
+			return "XXH64";
+		case Config::HashAlgorithm::XXH3_64:
+			return "XXH3-64";
+		case Config::HashAlgorithm::XXH3_128:
+			return "XXH3-128";
+		case Config::HashAlgorithm::CRC32C:
+			return "CRC32C";
+		case Config::HashAlgorithm::BLAKE3:
+			return "BLAKE3";
+	}
+	return "";
+}
+
+const char *Hasher::implementation(Config::HashAlgorithm algorithm) {
+	switch (algorithm) {
+		case Config::HashAlgorithm::XXH3_64:
+		case Config::HashAlgorithm::XXH3_128:
+			return hasAvx2() ? "AVX2" : "generic";
+		case Config::HashAlgorithm::CRC32C:
+			return hasCrc32cInstructions() ? "hardware" : "table";
+		case Config::HashAlgorithm::BLAKE3:
+			return isAvailable(algorithm) ? "libblake3" : "not built";
+		case Config::HashAlgorithm::XXH64:
+			break;
+	}
+	return "generic";
+}
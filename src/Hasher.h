@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "Config.h"
+
+// Streaming checksum of a file, with the algorithm chosen in the settings (HASH_ALGORITHM).
+// create() picks the fastest code path for this CPU at runtime: XXH3 uses a build compiled for
+// AVX2 when the processor has it, CRC32C the SSE4.2 or ARMv8 CRC instructions, and BLAKE3
+// does its own SIMD dispatch. The result doesn't depend on the code path.
+class Hasher {
+public:
+	// Result of a hash. Compared byte for byte and shown as canonical (big-endian) lowercase hex,
+	// the same text xxhsum, crc32c tools and b3sum print.
+	struct Digest {
+		static constexpr size_t MAX_SIZE = 32;
+		uint8_t bytes[MAX_SIZE] = {};
+		size_t size = 0;
+
+		static Digest fromUint64(uint64_t value);
+		static Digest fromUint32(uint32_t value);
+		std::string hex() const;
+
+		bool operator==(const Digest &other) const;
+		bool operator!=(const Digest &other) const { return !(*this == other); }
+	};
+
+	virtual ~Hasher() = default;
+
+	virtual void update(const void *data, size_t len) = 0;
+	// Hash of everything passed to update(). Call once.
+	virtual Digest digest() = 0;
+
+	// New hasher for 'algorithm'. Falls back to XXH3-64 if it isn't available in this build.
+	static std::unique_ptr<Hasher> create(Config::HashAlgorithm algorithm);
+	// False for BLAKE3 when built without libblake3
+	static bool isAvailable(Config::HashAlgorithm algorithm);
+	// Name shown in the settings and the history, e.g. "XXH3-128"
+	static const char *name(Config::HashAlgorithm algorithm);
+	// Code path create() uses on this CPU, e.g. "AVX2" (for the log)
+	static const char *implementation(Config::HashAlgorithm algorithm);
+};
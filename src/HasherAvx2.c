@@ -0,0 +1,42 @@
+// XXH3 compiled for AVX2 (this file alone is built with -mavx2, see CMakeLists.txt).
+// Plain C on purpose: it includes nothing but xxHash, so no inline function or template
+// shared with the rest of the program is ever emitted with AVX2 instructions.
+// Hasher::create() only uses it after checking the CPU. XXH_INLINE_ALL gives every xxHash
+// symbol of this file internal linkage, so it can't clash with the SSE2 build in libxxhash.
+#define XXH_INLINE_ALL
+#define XXH_VECTOR XXH_AVX2
+#include <xxhash.h>
+
+void *moveroXxh3Avx2Create(int wide) {
+	XXH3_state_t *state = XXH3_createState();
+	if (wide) {
+		XXH3_128bits_reset(state);
+	} else {
+		XXH3_64bits_reset(state);
+	}
+	return state;
+}
+
+void moveroXxh3Avx2Free(void *state) {
+	XXH3_freeState((XXH3_state_t *)state);
+}
+
+void moveroXxh3Avx2Update(void *state, int wide, const void *data, size_t len) {
+	if (wide) {
+		XXH3_128bits_update((XXH3_state_t *)state, data, len);
+	} else {
+		XXH3_64bits_update((XXH3_state_t *)state, data, len);
+	}
+}
+
+unsigned long long moveroXxh3Avx2Digest64(void *state) {
+	return XXH3_64bits_digest((XXH3_state_t *)state);
+}
+
+// Canonical (big-endian) 16 bytes, the same as XXH128_canonicalFromHash()
+void moveroXxh3Avx2Digest128(void *state, unsigned char out[16]) {
+	XXH128_canonical_t canonical;
+	XXH128_canonicalFromHash(&canonical, XXH3_128bits_digest((XXH3_state_t *)state));
+	for (int i = 0; i < 16; ++i)
+		out[i] = canonical.digest[i];
+}
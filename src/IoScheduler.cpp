@@ -0,0 +1,143 @@
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sys/sysmacros.h>
+
+#include "IoScheduler.h"
+#include "LogHelper.h"
+
+namespace fs = std::filesystem;
+
+IoScheduler::Lane IoScheduler::lane(dev_t src, dev_t dest) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return {deviceIndex(src), deviceIndex(dest)};
+}
+
+bool IoScheduler::isRotational(dev_t dev) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_devices[deviceIndex(dev)].rotational;
+}
+
+std::string IoScheduler::pairName(const Lane &lane) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto name = [this](int device) {
+		return fs::path(m_devices[device].name).filename().string();
+	};
+	return name(lane.src) + " -> " + name(lane.dest);
+}
+
+bool IoScheduler::hasStableName(const Lane &lane) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_devices[lane.src].sysfs && m_devices[lane.dest].sysfs;
+}
+
+uint64_t IoScheduler::soleUseStamp(const Lane &lane) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const Device &src = m_devices[lane.src];
+	const Device &dest = m_devices[lane.dest];
+	if (src.busy > 1 || dest.busy > 1)
+		return 0;
+	return src.starts + (lane.dest != lane.src ? dest.starts : 0) + 1;
+}
+
+bool IoScheduler::sameRotationalDisk(dev_t a, dev_t b) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	int device = deviceIndex(a);
+	return device == deviceIndex(b) && m_devices[device].rotational;
+}
+
+// Resolves st_dev to its disk: /sys/dev/block/MAJ:MIN links to the partition or whole disk,
+// a partition's parent directory is the disk. Mapped and RAID devices (dm-*, md*) report
+// their own queue/rotational. Network filesystems and btrfs use anonymous device numbers
+// without a sysfs entry; each of them is treated as a separate non-rotational device.
+// Must be called with m_mutex held.
+int IoScheduler::deviceIndex(dev_t dev) {
+	auto it = m_byDev.find(dev);
+	if (it != m_byDev.end())
+		return it->second;
+
+	Device device;
+	char sysPath[64];
+	snprintf(sysPath, sizeof(sysPath), "/sys/dev/block/%u:%u", major(dev), minor(dev));
+
+	std::error_code ec;
+	fs::path disk = fs::canonical(sysPath, ec);
+	if (!ec) {
+		if (fs::exists(disk / "partition", ec))
+			disk = disk.parent_path();
+		device.name = disk.string();
+		device.sysfs = true;
+
+		std::ifstream rotational(disk / "queue" / "rotational");
+		int value = 0;
+		device.rotational = (rotational >> value) && value == 1;
+	} else {
+		device.name = "dev:" + std::to_string(dev);
+	}
+
+	// Two partitions of the same disk share one entry
+	int index = -1;
+	for (size_t i = 0; i < m_devices.size(); ++i) {
+		if (m_devices[i].name == device.name) {
+			index = static_cast<int>(i);
+			break;
+		}
+	}
+	if (index < 0) {
+		LOG(LogLevel::INFO) << "I/O device:" << QString::fromStdString(device.name) << "Rotational:" << device.rotational;
+		m_devices.push_back(device);
+		index = static_cast<int>(m_devices.size() - 1);
+	}
+	m_byDev[dev] = index;
+	return index;
+}
+
+// Must be called with m_mutex held.
+bool IoScheduler::isFree(int device) const {
+	const Device &d = m_devices[device];
+	return !d.rotational || d.busy == 0;
+}
+
+bool IoScheduler::tryAcquire(const Lane &lane) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!isFree(lane.src) || !isFree(lane.dest))
+		return false;
+
+	// Same disk on both sides takes a single token
+	m_devices[lane.src].busy++;
+	m_devices[lane.src].starts++;
+	if (lane.dest != lane.src) {
+		m_devices[lane.dest].busy++;
+		m_devices[lane.dest].starts++;
+	}
+	return true;
+}
+
+void IoScheduler::release(const Lane &lane) {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_devices[lane.src].busy--;
+		if (lane.dest != lane.src)
+			m_devices[lane.dest].busy--;
+		m_generation++;
+	}
+	m_cond.notify_all();
+}
+
+uint64_t IoScheduler::generation() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_generation;
+}
+
+void IoScheduler::waitForRelease(uint64_t generation) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_cond.wait(lock, [&] { return m_generation != generation; });
+}
+
+void IoScheduler::wakeAll() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_generation++;
+	}
+	m_cond.notify_all();
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+// Decides which files the copy pool may copy at the same time.
+// Every file is a pair of devices (source, destination). The st_dev of each side is mapped to
+// the underlying block device through sysfs, so two partitions of one disk count as one device.
+//
+// A rotational disk is given to one file at a time: two streams on the same spindle make the
+// heads seek back and forth and are slower than one after the other. SSDs, NVMe and network
+// filesystems take any number of files. Files on disjoint devices run in parallel, so
+// consolidating several USB disks takes as long as the slowest disk instead of the sum.
+class IoScheduler {
+public:
+	// Devices of one file, as returned by lane()
+	struct Lane {
+		int src = -1;
+		int dest = -1;
+	};
+
+	// Maps a source and a destination st_dev to their devices (cached).
+	Lane lane(dev_t src, dev_t dest);
+
+	// True if st_dev lives on a spinning disk (queue/rotational in sysfs)
+	bool isRotational(dev_t dev);
+	// Readable name of a device pair, e.g. "sdb -> nvme0n1". Stable across jobs for real disks.
+	std::string pairName(const Lane &lane);
+	// True if both devices are sysfs block devices. The others are named after anonymous
+	// device numbers (FUSE, NFS, btrfs, overlayfs) that change between boots and mounts.
+	bool hasStableName(const Lane &lane);
+
+	// Changes whenever another file starts on a device of 'lane'. 0 while another file is
+	// using one of them. Equal values before and after a copy mean it had the devices to itself.
+	uint64_t soleUseStamp(const Lane &lane);
+
+	// True if both st_dev live on the same spinning disk
+	bool sameRotationalDisk(dev_t a, dev_t b);
+
+	// Takes the devices of 'lane' if all of them are free. Never blocks.
+	bool tryAcquire(const Lane &lane);
+	// Gives the devices back and wakes the workers waiting in waitForRelease().
+	void release(const Lane &lane);
+
+	// Counter bumped by every release(). Read it before looking for work, then pass it
+	// to waitForRelease() so a release in between isn't missed.
+	uint64_t generation();
+	void waitForRelease(uint64_t generation);
+	// Wakes all waiting workers (cancel).
+	void wakeAll();
+
+private:
+	struct Device {
+		std::string name; // sysfs path of the disk, or "dev:<st_dev>" without one
+		bool rotational = false;
+		bool sysfs = false; // Named after its sysfs node, the same after a reboot
+		int busy = 0; // Files currently using the device
+		uint64_t starts = 0; // Files started on the device
+	};
+
+	std::mutex m_mutex;
+	std::condition_variable m_cond;
+	std::vector<Device> m_devices;
+	std::map<dev_t, int> m_byDev; // st_dev -> index in m_devices
+	uint64_t m_generation = 0;
+
+	int deviceIndex(dev_t dev);
+	bool isFree(int device) const;
+};
@@ -350,6 +350,10 @@ MainWindow::MainWindow(
 		case OperationMode::Move:
 			m_modeString = tr("Moving");
 			break;
+		case OperationMode::Compare:
+			m_modeString = tr("Comparing");
+			m_compareMode = true;
+			break;
 		case OperationMode::PreviewUI:
 			m_modeString = tr("Preview UI Mode");
 			break;
@@ -373,7 +377,8 @@ MainWindow::MainWindow(
 	if (!Config::DRY_RUN) {
 		source = QString::fromStdString(sources[0]);
 		QFileInfo info(QDir::cleanPath(source));
-		m_sourceFolder = info.absolutePath();
+		// Compare shows the compared folder itself, the others the folder the items come from
+		m_sourceFolder = m_compareMode ? info.absoluteFilePath() : info.absolutePath();
 	} else {
 		m_sourceFolder = "Dry run mode";
 	}
@@ -425,8 +430,12 @@ MainWindow::MainWindow(
 		m_status_string = m_modeString;
 		ui->labelStatus->setText(m_status_string);
 	} else {
-		CopyWorker::Mode workerMode =
-			(mode == OperationMode::Move) ? CopyWorker::Move : CopyWorker::Copy;
+		CopyWorker::Mode workerMode = CopyWorker::Copy;
+		if (mode == OperationMode::Move) {
+			workerMode = CopyWorker::Move;
+		} else if (mode == OperationMode::Compare) {
+			workerMode = CopyWorker::Compare;
+		}
 		m_worker = new CopyWorker(sources, dest, workerMode, this);
 
 		connect(m_worker, &CopyWorker::progressChanged, 
@@ -454,6 +463,7 @@ MainWindow::MainWindow(
 			&MainWindow::onConflictNeeded,
 			Qt::QueuedConnection);
 		connect(m_worker, &CopyWorker::fileCompleted, this, &MainWindow::onFileCompleted);
+		connect(m_worker, &CopyWorker::jobNote, this, &MainWindow::onJobNote);
 	}
 
 	connect(ui->btnPause, &QPushButton::clicked, this, &MainWindow::onTogglePause);
@@ -550,6 +560,12 @@ void MainWindow::onStatusChanged(CopyWorker::Status status) {
 		case CopyWorker::Verifying:
 			m_status_string = tr("Verifying Checksum...");
 			break;
+		case CopyWorker::Repairing:
+			m_status_string = tr("Repairing damaged blocks...");
+			break;
+		case CopyWorker::Comparing:
+			m_status_string = tr("Comparing...");
+			break;
 	}
 
 	m_status_code = status;
@@ -645,11 +661,35 @@ void MainWindow::onError(CopyWorker::FileError err) {
 		case CopyWorker::DestinationIsDirectory:
 			msg = tr("Collision: Destination is a directory, not a link.");
 			break;
+		case CopyWorker::MissingInDestination:
+			msg = tr("Missing in destination");
+			break;
+		case CopyWorker::ExtraInDestination:
+			msg = tr("Only in destination");
+			break;
+		case CopyWorker::SizeMismatch:
+			msg = tr("Size differs");
+			break;
+		case CopyWorker::ContentMismatch:
+			msg = tr("Content differs");
+			break;
 		default:
 			msg = tr("Unknown error");
 			break;
 	}
 
+	// A comparison lists its differences when it is done instead of opening the errors tab for each one.
+	// The detail is e.g. the two sizes of a SizeMismatch.
+	if (m_compareMode && !err.path.isEmpty()) {
+		if (!err.extraInfo.isEmpty())
+			msg += " (" + err.extraInfo + ")";
+		LOG(LogLevel::INFO) << "Difference: " + err.path + ": " + msg;
+		logHistory(err.path, msg);
+		m_differences++;
+		m_progress_updated = true;
+		return;
+	}
+
 	QString logMsg = err.path.isEmpty() ? msg : (err.path + ": " + msg);
 	LOG(LogLevel::ERROR) << "Error: " + logMsg;
 	ui->labelStatus->setText(msg);
@@ -865,13 +905,25 @@ void MainWindow::onFinished() {
 	ui->labelStatus->setText(tr("Done."));
 	ui->btnPause->setEnabled(false);
 
+	if (m_compareMode) {
+		ui->labelStatus->setText(m_differences == 0 ? tr("No differences.") : tr("%1 differences found.").arg(m_differences));
+		if (m_differences > 0) {
+			m_detailsWindow->populateErrorTree(ui->treeWidgetErrors, m_jobHistory);
+			ui->tabWidget->setCurrentWidget(ui->tab_2);
+			if (!ui->tabWidget->isVisible())
+				onToggleDetails();
+		}
+	}
+
 	// Save history
 	if (!m_jobHistory.isEmpty()) {
 		if (m_detailsWindow) {
 			QString currentTime = QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss");
 			m_detailsWindow->setSourceDest(m_sourceFolder, m_destFolder);
+			m_detailsWindow->setJobDetails(m_jobDetails);
 			m_detailsWindow->addHistoryEntry(currentTime, m_modeString, m_jobHistory);
 			m_jobHistory.clear();
+			m_jobDetails.clear();
 			m_loggedFiles.clear();
 			// Allow user resizing
 			ui->treeWidget->header()->setSectionResizeMode(0, QHeaderView::Interactive);
@@ -892,8 +944,8 @@ void MainWindow::onFinished() {
   copied and verified. It logs the file to history and triggers
   the file manager highlight if enabled.
 ------------------------------------------------------------------*/
-void MainWindow::onFileCompleted(QString path, QString srcHash, QString destHash, bool isTopLevel) {
-	logHistory(path, "", srcHash, destHash);
+void MainWindow::onFileCompleted(QString path, QString srcHash, QString destHash, bool isTopLevel, QString note) {
+	logHistory(path, "", srcHash, destHash, note);
 
 	if (isTopLevel && Config::SELECT_FILES_AFTER_COPY) {
 		m_topLevelItems.append(path);
@@ -902,6 +954,16 @@ void MainWindow::onFileCompleted(QString path, QString srcHash, QString destHash
 }
 
 
+/*----------------------------------------------------------------
+  Slot that collects job-level information from the worker
+  (e.g. the buffer size chosen by the autotuner). It is saved
+  with the job in the history.
+------------------------------------------------------------------*/
+void MainWindow::onJobNote(QString note) {
+	m_jobDetails.append(note);
+}
+
+
 /*----------------------------------------------------------------
   Updates the progress bar on the application's taskbar/dock icon
   using the D-Bus protocol for desktop integration.
@@ -1093,7 +1155,7 @@ void MainWindow::generateTestData() {
   point it's saved to the details/history view.
 ------------------------------------------------------------------*/
 void MainWindow::logHistory(
-	const QString &path, const QString &error, const QString &srcHash, const QString &destHash) {
+	const QString &path, const QString &error, const QString &srcHash, const QString &destHash, const QString &note) {
 	if (!Config::LOG_HISTORY_ENABLED)
 		return;
 
@@ -1110,12 +1172,15 @@ void MainWindow::logHistory(
 				if (!destHash.isEmpty()) {
 					entry.destHash = destHash;
 				}
+				if (!note.isEmpty()) {
+					entry.note = note;
+				}
 				return;
 			}
 		}
 	}
 	// Otherwise add new entry
-	m_jobHistory.append({path, error, srcHash, destHash});
+	m_jobHistory.append({path, error, srcHash, destHash, note});
 	m_loggedFiles.insert(path);
 }
 
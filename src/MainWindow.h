@@ -15,6 +15,7 @@
 enum class OperationMode {
 	Copy,
 	Move,
+	Compare,
 	Settings,
 	PreviewUI
 };
@@ -70,14 +71,15 @@ private slots:
 	void onError(CopyWorker::FileError err);
 	void onFinished();
 	void onConflictNeeded(QString src, QString dest, QString suggestedName);
-	void onFileCompleted(QString path, QString srcHash, QString destHash, bool isTopLevel);
+	void onFileCompleted(QString path, QString srcHash, QString destHash, bool isTopLevel, QString note);
+	void onJobNote(QString note);
 
 protected:
 	void closeEvent(QCloseEvent *event) override;
 	void resizeEvent(QResizeEvent *event) override;
 	// void moveEvent(QMoveEvent *event) override;
 
-	private : void logHistory(const QString &path, const QString &error = "", const QString &srcHash = "", const QString &destHash = "");
+	private : void logHistory(const QString &path, const QString &error = "", const QString &srcHash = "", const QString &destHash = "", const QString &note = "");
 	void highlightFile(const QStringList &paths);
 	void updateTaskbarProgress(int percent);
 	void onToggleDetails();
@@ -94,6 +96,7 @@ protected:
 	DetailsWindow *m_detailsWindow = nullptr;
 	QStringList m_topLevelItems;
 	QList<HistoryEntry> m_jobHistory;
+	QStringList m_jobDetails;
 	QSet<QString> m_loggedFiles;
 	CopyWorker *m_worker;
 	SpeedGraph *m_graph;
@@ -125,4 +128,6 @@ protected:
 	bool m_testMode = false;
 	bool m_progress_updated = false;
 	bool m_resize_event = false;
+	bool m_compareMode = false;
+	int m_differences = 0; // Compare mode
 };
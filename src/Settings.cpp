@@ -7,6 +7,7 @@
 #include <QTextStream>
 
 #include "Config.h"
+#include "Hasher.h"
 #include "MainWindow.h"
 #include "Settings.h"
 #include "ui_Settings.h" // Header generated by uic from Settings.ui
@@ -42,6 +43,8 @@ Settings::Settings(QWidget *parent)
 	// Load values from Config
 	ui->checkLogHistory->setChecked(Config::LOG_HISTORY_ENABLED);
 	ui->checkChecksum->setChecked(Config::CHECKSUM_ENABLED);
+	ui->checkHashManifest->setChecked(Config::WRITE_HASH_MANIFEST);
+	ui->checkHashCache->setChecked(Config::HASH_CACHE);
 	ui->checkFileModTime->setChecked(Config::COPY_FILE_MODIFICATION_TIME);
 	ui->checkSanitizeFilenames->setChecked(Config::SANITIZE_FILENAMES);
 	ui->checkSelectFiles->setChecked(Config::SELECT_FILES_AFTER_COPY);
@@ -56,6 +59,30 @@ Settings::Settings(QWidget *parent)
 	ui->groupBox_DryRun->setChecked(Config::DRY_RUN);
 	ui->spinDryRunSize->setValue(Config::DRY_RUN_FILE_SIZE / (1024 * 1024));
 	ui->spinDryRunFill->setValue(Config::DRY_RUN_FILL_TARGET / (1024 * 1024));
+	ui->spinQueueDepth->setValue(Config::IO_QUEUE_DEPTH);
+	ui->checkReflink->setChecked(Config::REFLINK_ENABLED);
+	ui->groupBox_DirectWrite->setChecked(Config::DIRECT_WRITE_ENABLED);
+	ui->spinDirectWriteThreshold->setValue(Config::DIRECT_WRITE_THRESHOLD_MB);
+	ui->checkPreallocate->setChecked(Config::PREALLOCATE_ENABLED);
+	ui->checkReserveJobSpace->setChecked(Config::RESERVE_JOB_SPACE);
+	ui->checkSparseFiles->setChecked(Config::SPARSE_FILES_ENABLED);
+	ui->checkSparsifyZeroRuns->setChecked(Config::SPARSIFY_ZERO_RUNS);
+	ui->spinParallelThreads->setValue(Config::PARALLEL_COPY_THREADS);
+	ui->spinParallelThreshold->setValue(Config::PARALLEL_COPY_THRESHOLD_MB);
+	ui->spinCopyThreads->setValue(Config::COPY_THREADS);
+	ui->spinHddWindow->setValue(Config::HDD_WINDOW_MB);
+	ui->checkPhysicalOrder->setChecked(Config::ORDER_BY_PHYSICAL_LOCATION);
+	ui->checkBufferAutotune->setChecked(Config::BUFFER_AUTOTUNE);
+	ui->spinWritebackWindow->setValue(Config::WRITEBACK_WINDOW_MB);
+	ui->spinVerifyGroupMB->setValue(Config::VERIFY_GROUP_MB);
+	ui->spinVerifyGroupFiles->setValue(Config::VERIFY_GROUP_FILES);
+	ui->checkAsyncVerify->setChecked(Config::ASYNC_VERIFY);
+	ui->checkSampledVerify->setChecked(Config::SAMPLED_VERIFY);
+	ui->spinSamplePercent->setValue(Config::VERIFY_SAMPLE_PERCENT);
+	ui->spinSampleMinMB->setValue(Config::VERIFY_SAMPLE_MIN_MB);
+	ui->checkHashTree->setChecked(Config::HASH_TREE);
+	ui->checkRepair->setChecked(Config::REPAIR_ENABLED);
+	ui->spinRepairRetries->setValue(Config::REPAIR_MAX_RETRIES);
 
 	// Menu Navigation
 	// When the menu selection changes, go to the correct page and run page-specific logic
@@ -93,6 +120,27 @@ Settings::Settings(QWidget *parent)
 		}
 	}
 
+	// Checksum algorithms available in this build
+	for (auto algorithm : {Config::HashAlgorithm::XXH64, Config::HashAlgorithm::XXH3_64, Config::HashAlgorithm::XXH3_128,
+						   Config::HashAlgorithm::CRC32C, Config::HashAlgorithm::BLAKE3}) {
+		if (Hasher::isAvailable(algorithm))
+			ui->comboHashAlgorithm->addItem(Hasher::name(algorithm), static_cast<int>(algorithm));
+	}
+	int hashIdx = ui->comboHashAlgorithm->findData(static_cast<int>(Config::HASH_ALGORITHM));
+	if (hashIdx != -1)
+		ui->comboHashAlgorithm->setCurrentIndex(hashIdx);
+
+	// Performance page
+	ui->comboCopyEngine->addItem(tr("Auto"), static_cast<int>(Config::CopyEngine::Auto));
+	ui->comboCopyEngine->addItem(tr("Read/Write"), static_cast<int>(Config::CopyEngine::ReadWrite));
+	ui->comboCopyEngine->addItem(tr("io_uring"), static_cast<int>(Config::CopyEngine::IoUring));
+	ui->comboCopyEngine->addItem(tr("copy_file_range (in-kernel)"), static_cast<int>(Config::CopyEngine::CopyFileRange));
+	ui->comboCopyEngine->addItem(tr("Pipeline (reader thread)"), static_cast<int>(Config::CopyEngine::Pipeline));
+	ui->comboCopyEngine->addItem(tr("Memory-mapped source"), static_cast<int>(Config::CopyEngine::Mmap));
+	int engineIdx = ui->comboCopyEngine->findData(static_cast<int>(Config::COPY_ENGINE));
+	if (engineIdx != -1)
+		ui->comboCopyEngine->setCurrentIndex(engineIdx);
+
 	// Restart warning logic
 	ui->lblRestartWarning->setVisible(false);
 	ui->btnRestart->setVisible(false);
@@ -148,6 +196,8 @@ Settings::Settings(QWidget *parent)
 	connect(ui->btnDefaults, &QPushButton::clicked, this, [this]() {
 		ui->checkLogHistory->setChecked(Config::Defaults::LOG_HISTORY_ENABLED);
 		ui->checkChecksum->setChecked(Config::Defaults::CHECKSUM_ENABLED);
+		ui->checkHashManifest->setChecked(Config::Defaults::WRITE_HASH_MANIFEST);
+		ui->checkHashCache->setChecked(Config::Defaults::HASH_CACHE);
 		ui->checkFileModTime->setChecked(Config::Defaults::COPY_FILE_MODIFICATION_TIME);
 		ui->checkSanitizeFilenames->setChecked(Config::Defaults::SANITIZE_FILENAMES);
 		ui->checkSelectFiles->setChecked(Config::Defaults::SELECT_FILES_AFTER_COPY);
@@ -162,6 +212,38 @@ Settings::Settings(QWidget *parent)
 		ui->groupBox_DryRun->setChecked(Config::Defaults::DRY_RUN);
 		ui->spinDryRunSize->setValue(Config::Defaults::DRY_RUN_FILE_SIZE_MB);
 		ui->spinDryRunFill->setValue(Config::Defaults::DRY_RUN_FILL_TARGET_MB);
+		ui->spinQueueDepth->setValue(Config::Defaults::IO_QUEUE_DEPTH);
+		ui->checkReflink->setChecked(Config::Defaults::REFLINK_ENABLED);
+		ui->groupBox_DirectWrite->setChecked(Config::Defaults::DIRECT_WRITE_ENABLED);
+		ui->spinDirectWriteThreshold->setValue(Config::Defaults::DIRECT_WRITE_THRESHOLD_MB);
+		ui->checkPreallocate->setChecked(Config::Defaults::PREALLOCATE_ENABLED);
+		ui->checkReserveJobSpace->setChecked(Config::Defaults::RESERVE_JOB_SPACE);
+		ui->checkSparseFiles->setChecked(Config::Defaults::SPARSE_FILES_ENABLED);
+		ui->checkSparsifyZeroRuns->setChecked(Config::Defaults::SPARSIFY_ZERO_RUNS);
+		ui->spinParallelThreads->setValue(Config::Defaults::PARALLEL_COPY_THREADS);
+		ui->spinParallelThreshold->setValue(Config::Defaults::PARALLEL_COPY_THRESHOLD_MB);
+		ui->spinCopyThreads->setValue(Config::Defaults::COPY_THREADS);
+		ui->spinHddWindow->setValue(Config::Defaults::HDD_WINDOW_MB);
+		ui->checkPhysicalOrder->setChecked(Config::Defaults::ORDER_BY_PHYSICAL_LOCATION);
+		ui->checkBufferAutotune->setChecked(Config::Defaults::BUFFER_AUTOTUNE);
+		ui->spinWritebackWindow->setValue(Config::Defaults::WRITEBACK_WINDOW_MB);
+		ui->spinVerifyGroupMB->setValue(Config::Defaults::VERIFY_GROUP_MB);
+		ui->spinVerifyGroupFiles->setValue(Config::Defaults::VERIFY_GROUP_FILES);
+		ui->checkAsyncVerify->setChecked(Config::Defaults::ASYNC_VERIFY);
+		ui->checkSampledVerify->setChecked(Config::Defaults::SAMPLED_VERIFY);
+		ui->spinSamplePercent->setValue(Config::Defaults::VERIFY_SAMPLE_PERCENT);
+		ui->spinSampleMinMB->setValue(Config::Defaults::VERIFY_SAMPLE_MIN_MB);
+		ui->checkHashTree->setChecked(Config::Defaults::HASH_TREE);
+		ui->checkRepair->setChecked(Config::Defaults::REPAIR_ENABLED);
+		ui->spinRepairRetries->setValue(Config::Defaults::REPAIR_MAX_RETRIES);
+
+		int defEngineIdx = ui->comboCopyEngine->findData(static_cast<int>(Config::Defaults::COPY_ENGINE));
+		if (defEngineIdx != -1)
+			ui->comboCopyEngine->setCurrentIndex(defEngineIdx);
+
+		int defHashIdx = ui->comboHashAlgorithm->findData(static_cast<int>(Config::Defaults::HASH_ALGORITHM));
+		if (defHashIdx != -1)
+			ui->comboHashAlgorithm->setCurrentIndex(defHashIdx);
 
 		QString defLang = Config::Defaults::LANGUAGE;
 		int defLangIdx = ui->comboLanguage->findData(defLang);
@@ -297,6 +379,8 @@ bool Settings::isSystemDark() {
 void Settings::saveSettings() {
 	Config::LOG_HISTORY_ENABLED = ui->checkLogHistory->isChecked();
 	Config::CHECKSUM_ENABLED = ui->checkChecksum->isChecked();
+	Config::WRITE_HASH_MANIFEST = ui->checkHashManifest->isChecked();
+	Config::HASH_CACHE = ui->checkHashCache->isChecked();
 	Config::COPY_FILE_MODIFICATION_TIME = ui->checkFileModTime->isChecked();
 	Config::SANITIZE_FILENAMES = ui->checkSanitizeFilenames->isChecked();
 	Config::SELECT_FILES_AFTER_COPY = ui->checkSelectFiles->isChecked();
@@ -312,6 +396,32 @@ void Settings::saveSettings() {
 	Config::DRY_RUN = ui->groupBox_DryRun->isChecked();
 	Config::DRY_RUN_FILE_SIZE = (uintmax_t)ui->spinDryRunSize->value() * 1024 * 1024;
 	Config::DRY_RUN_FILL_TARGET = (uintmax_t)ui->spinDryRunFill->value() * 1024 * 1024;
+	Config::COPY_ENGINE = static_cast<Config::CopyEngine>(ui->comboCopyEngine->currentData().toInt());
+	Config::HASH_ALGORITHM = static_cast<Config::HashAlgorithm>(ui->comboHashAlgorithm->currentData().toInt());
+	Config::IO_QUEUE_DEPTH = ui->spinQueueDepth->value();
+	Config::REFLINK_ENABLED = ui->checkReflink->isChecked();
+	Config::DIRECT_WRITE_ENABLED = ui->groupBox_DirectWrite->isChecked();
+	Config::DIRECT_WRITE_THRESHOLD_MB = ui->spinDirectWriteThreshold->value();
+	Config::PREALLOCATE_ENABLED = ui->checkPreallocate->isChecked();
+	Config::RESERVE_JOB_SPACE = ui->checkReserveJobSpace->isChecked();
+	Config::SPARSE_FILES_ENABLED = ui->checkSparseFiles->isChecked();
+	Config::SPARSIFY_ZERO_RUNS = ui->checkSparsifyZeroRuns->isChecked();
+	Config::PARALLEL_COPY_THREADS = ui->spinParallelThreads->value();
+	Config::PARALLEL_COPY_THRESHOLD_MB = ui->spinParallelThreshold->value();
+	Config::COPY_THREADS = ui->spinCopyThreads->value();
+	Config::HDD_WINDOW_MB = ui->spinHddWindow->value();
+	Config::ORDER_BY_PHYSICAL_LOCATION = ui->checkPhysicalOrder->isChecked();
+	Config::BUFFER_AUTOTUNE = ui->checkBufferAutotune->isChecked();
+	Config::WRITEBACK_WINDOW_MB = ui->spinWritebackWindow->value();
+	Config::VERIFY_GROUP_MB = ui->spinVerifyGroupMB->value();
+	Config::VERIFY_GROUP_FILES = ui->spinVerifyGroupFiles->value();
+	Config::ASYNC_VERIFY = ui->checkAsyncVerify->isChecked();
+	Config::SAMPLED_VERIFY = ui->checkSampledVerify->isChecked();
+	Config::VERIFY_SAMPLE_PERCENT = ui->spinSamplePercent->value();
+	Config::VERIFY_SAMPLE_MIN_MB = ui->spinSampleMinMB->value();
+	Config::HASH_TREE = ui->checkHashTree->isChecked();
+	Config::REPAIR_ENABLED = ui->checkRepair->isChecked();
+	Config::REPAIR_MAX_RETRIES = ui->spinRepairRetries->value();
 	Config::LANGUAGE = ui->comboLanguage->currentData().toString();
 
 	Config::save();
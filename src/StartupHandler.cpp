@@ -5,6 +5,7 @@
 #include <QClipboard>
 #include <QCoreApplication>
 #include <QDir>
+#include <QFileInfo>
 #include <QMimeData>
 #include <QRegularExpression>
 #include <QUrl>
@@ -32,6 +33,24 @@ StartupOptions StartupHandler::parse(const QStringList &args) {
 		return options;
 	}
 
+	// Compare two existing trees. Both are given, the clipboard isn't used.
+	if (arg1 == "compare") {
+		if (args.size() < 4) {
+			options.valid = false;
+			options.errorMessage = tr("Compare needs a source and a destination!");
+			return options;
+		}
+		if (!QFileInfo::exists(args[2]) || !QFileInfo::exists(args[3])) {
+			options.valid = false;
+			options.errorMessage = tr("Source or destination does not exist!");
+			return options;
+		}
+		options.mode = OperationMode::Compare;
+		options.sources.push_back(args[2].toStdString());
+		options.dest = args[3].toStdString();
+		return options;
+	}
+
 	// Determine Mode and Dest from Args
 	QString destDir;
 	if (arg1 == "cp") {
@@ -0,0 +1,348 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/uio.h>
+
+#if HAVE_LIBURING
+#include <liburing.h>
+#endif
+
+#include "LogHelper.h"
+#include "UringEngine.h"
+
+// Slots in the fixed file table
+static constexpr int FIXED_SRC = 0;
+static constexpr int FIXED_DEST = 1;
+
+// Copies 'size' bytes from fdIn to fdOut with several chunks in flight.
+UringEngine::Result UringEngine::copy(int fdIn, int fdOut, uint64_t size, const DataCallback &onData, const ProgressCallback &onProgress, bool padTail) {
+	return run(fdIn, fdOut, size, onData, onProgress, padTail);
+}
+
+// Reads 'size' bytes from fd with several chunks in flight (verification).
+UringEngine::Result UringEngine::read(int fd, uint64_t size, const DataCallback &onData, const ProgressCallback &onProgress) {
+	return run(fd, -1, size, onData, onProgress, false);
+}
+
+#if HAVE_LIBURING
+
+// Sets up the ring with one queue slot per ring buffer and
+// registers the buffers and a two-entry file table with the kernel.
+UringEngine::UringEngine(BufferRing &ring) : m_buffers(ring) {
+	unsigned queueDepth = static_cast<unsigned>(ring.count());
+	m_chunkSize = ring.chunkSize();
+
+	// Each slot has at most one request in the kernel, so queueDepth entries are enough
+	m_ring = new io_uring;
+	int ret = io_uring_queue_init(queueDepth, m_ring, 0);
+	if (ret < 0) {
+		// ENOSYS: kernel without io_uring, EPERM: disabled via kernel.io_uring_disabled
+		LOG(LogLevel::INFO) << "io_uring not available:" << strerror(-ret) << "- using read/write loop.";
+		delete m_ring;
+		m_ring = nullptr;
+		return;
+	}
+
+	m_slots.resize(queueDepth);
+	std::vector<iovec> iovecs;
+	iovecs.reserve(queueDepth);
+
+	for (unsigned i = 0; i < queueDepth; ++i) {
+		m_slots[i].buf = ring.buffer(i);
+		m_slots[i].index = static_cast<int>(i);
+		iovecs.push_back({ring.buffer(i), ring.bufferSize()});
+	}
+
+	// Registered buffers are pinned once instead of on every request.
+	// This fails when RLIMIT_MEMLOCK is too small; unregistered buffers still work.
+	m_fixedBuffers = (io_uring_register_buffers(m_ring, iovecs.data(), iovecs.size()) == 0);
+
+	// Sparse file table, filled for every transfer with io_uring_register_files_update()
+	int fds[2] = {-1, -1};
+	m_fixedFiles = (io_uring_register_files(m_ring, fds, 2) == 0);
+
+	LOG(LogLevel::INFO) << "io_uring engine ready. Queue depth:" << queueDepth
+						<< "Chunk:" << m_chunkSize
+						<< "Registered buffers:" << m_fixedBuffers
+						<< "Fixed files:" << m_fixedFiles;
+	m_ready = true;
+}
+
+UringEngine::~UringEngine() {
+	if (m_ring) {
+		// Tearing down the ring also drops the registered buffers and files
+		io_uring_queue_exit(m_ring);
+		delete m_ring;
+	}
+}
+
+// Points the fixed file table at the descriptors of the current transfer.
+void UringEngine::bindFiles(int fdIn, int fdOut) {
+	m_filesBound = false;
+	if (!m_fixedFiles)
+		return;
+
+	int fds[2] = {fdIn, fdOut};
+	m_filesBound = (io_uring_register_files_update(m_ring, 0, fds, 2) == 2);
+}
+
+// Clears the fixed file table so the kernel drops its file references.
+void UringEngine::releaseFiles() {
+	if (!m_filesBound)
+		return;
+
+	int fds[2] = {-1, -1};
+	io_uring_register_files_update(m_ring, 0, fds, 2);
+	m_filesBound = false;
+}
+
+// Queues a read for the unfinished part of the slot.
+void UringEngine::queueRead(Slot &slot, int fd, bool alignLength) {
+	// Never NULL: every slot owns at most one entry and the ring has one entry per slot
+	io_uring_sqe *sqe = io_uring_get_sqe(m_ring);
+	size_t remaining = slot.len - slot.done;
+
+	// O_DIRECT needs block-sized reads. Reading past EOF just returns fewer bytes,
+	// so rounding up is safe for the tail of the file.
+	if (alignLength) {
+		remaining = std::min((remaining + ALIGNMENT - 1) & ~(ALIGNMENT - 1), m_chunkSize - slot.done);
+	}
+
+	int target = m_filesBound ? FIXED_SRC : fd;
+	char *dst = slot.buf + slot.done;
+	uint64_t offset = slot.offset + slot.done;
+
+	if (m_fixedBuffers) {
+		io_uring_prep_read_fixed(sqe, target, dst, remaining, offset, slot.index);
+	} else {
+		io_uring_prep_read(sqe, target, dst, remaining, offset);
+	}
+	if (m_filesBound) {
+		io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE);
+	}
+	io_uring_sqe_set_data(sqe, &slot);
+	slot.state = Slot::Reading;
+}
+
+// Queues a write for the unfinished part of the slot.
+void UringEngine::queueWrite(Slot &slot, int fd) {
+	io_uring_sqe *sqe = io_uring_get_sqe(m_ring);
+	int target = m_filesBound ? FIXED_DEST : fd;
+	const char *src = slot.buf + slot.done;
+	uint64_t offset = slot.offset + slot.done;
+
+	if (m_fixedBuffers) {
+		io_uring_prep_write_fixed(sqe, target, src, slot.writeLen - slot.done, offset, slot.index);
+	} else {
+		io_uring_prep_write(sqe, target, src, slot.writeLen - slot.done, offset);
+	}
+	if (m_filesBound) {
+		io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE);
+	}
+	io_uring_sqe_set_data(sqe, &slot);
+	slot.state = Slot::Writing;
+}
+
+// Main loop shared by copy() and read(). fdOut < 0 means read-only (verification).
+// Reads are queued for every free slot, finished reads are passed to onData in
+// file order and then written out, and a slot is reused once its write completes.
+// On failure no new requests are queued, but we keep reaping completions until
+// the kernel is done with all of our buffers.
+UringEngine::Result UringEngine::run(int fdIn, int fdOut, uint64_t size, const DataCallback &onData, const ProgressCallback &onProgress, bool padTail) {
+	const bool writing = (fdOut >= 0);
+	m_chunkSize = m_buffers.chunkSize();
+	bindFiles(fdIn, fdOut);
+
+	uint64_t nextRead = 0; // Next offset to queue for reading
+	uint64_t nextData = 0; // Next offset to hand to onData (keeps hashing in order)
+	int inFlight = 0; // Requests currently owned by the kernel
+	Result result = Ok;
+
+	while (true) {
+		// Keep the queue full while there is data left
+		if (result == Ok) {
+			for (auto &slot : m_slots) {
+				if (nextRead >= size)
+					break;
+				if (slot.state != Slot::Free)
+					continue;
+
+				slot.offset = nextRead;
+				slot.len = static_cast<size_t>(std::min<uint64_t>(m_chunkSize, size - nextRead));
+				slot.done = 0;
+				queueRead(slot, fdIn, !writing);
+				nextRead += slot.len;
+				inFlight++;
+			}
+		}
+
+		if (inFlight == 0)
+			break;
+
+		int ret = io_uring_submit(m_ring);
+		if (ret < 0 && ret != -EINTR && ret != -EAGAIN && ret != -EBUSY) {
+			// The ring is unusable; let the caller fall back for the remaining files
+			LOG(LogLevel::ERROR) << "io_uring_submit failed:" << strerror(-ret);
+			m_ready = false;
+			result = ReadFailed;
+			break;
+		}
+
+		io_uring_cqe *cqe = nullptr;
+		ret = io_uring_wait_cqe(m_ring, &cqe);
+		if (ret == -EINTR)
+			continue;
+		if (ret < 0) {
+			LOG(LogLevel::ERROR) << "io_uring_wait_cqe failed:" << strerror(-ret);
+			m_ready = false;
+			result = ReadFailed;
+			break;
+		}
+
+		Slot &slot = *static_cast<Slot *>(io_uring_cqe_get_data(cqe));
+		int res = cqe->res;
+		io_uring_cqe_seen(m_ring, cqe);
+		inFlight--;
+
+		if (slot.state == Slot::Reading) {
+			if (res == -EINTR || res == -EAGAIN) {
+				res = 0; // Retry below
+			} else if (res < 0) {
+				LOG(LogLevel::ERROR) << "io_uring read failed:" << strerror(-res);
+				if (result == Ok)
+					result = ReadFailed;
+				slot.state = Slot::Free;
+				continue;
+			} else if (res == 0) {
+				if (result == Ok)
+					result = UnexpectedEOF;
+				slot.state = Slot::Free;
+				continue;
+			}
+
+			slot.done += res;
+			if (slot.done < slot.len) {
+				// Short read: fetch the rest into the same slot
+				if (result == Ok) {
+					queueRead(slot, fdIn, !writing);
+					inFlight++;
+				} else {
+					slot.state = Slot::Free;
+				}
+				continue;
+			}
+			slot.state = Slot::Ready;
+
+		} else if (slot.state == Slot::Writing) {
+			if (res == -EINTR || res == -EAGAIN) {
+				res = 0; // Retry below
+			} else if (res <= 0) {
+				LOG(LogLevel::ERROR) << "io_uring write failed:" << strerror(-res);
+				if (result == Ok)
+					result = WriteFailed;
+				slot.state = Slot::Free;
+				continue;
+			}
+
+			slot.done += res;
+			if (slot.done < slot.writeLen) {
+				// Short write: push the rest from the same slot
+				if (result == Ok) {
+					queueWrite(slot, fdOut);
+					inFlight++;
+				} else {
+					slot.state = Slot::Free;
+				}
+				continue;
+			}
+			slot.state = Slot::Free;
+			if (result == Ok && !onProgress(slot.len))
+				result = Aborted;
+		}
+
+		// Hand finished reads to the caller in file order, then write them out
+		bool advanced = true;
+		while (advanced && result == Ok) {
+			advanced = false;
+			for (auto &ready : m_slots) {
+				if (ready.state != Slot::Ready || ready.offset != nextData)
+					continue;
+
+				onData(ready.buf, ready.len);
+				nextData += ready.len;
+				advanced = true;
+
+				if (writing) {
+					ready.done = 0;
+					ready.writeLen = ready.len;
+					// O_DIRECT destination: only the last chunk can be unaligned
+					if (padTail && ready.len % ALIGNMENT != 0) {
+						ready.writeLen = (ready.len + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+						std::memset(ready.buf + ready.len, 0, ready.writeLen - ready.len);
+					}
+					queueWrite(ready, fdOut);
+					inFlight++;
+				} else {
+					ready.state = Slot::Free;
+					if (!onProgress(ready.len))
+						result = Aborted;
+				}
+				break;
+			}
+		}
+	}
+
+	// The ring itself failed: the caller's fallback reuses these buffers, so wait until the
+	// kernel is done with them first. Entries still in the submission queue never reached it.
+	if (!m_ready) {
+		shutdown(inFlight - static_cast<int>(io_uring_sq_ready(m_ring)));
+	}
+
+	// Slots left in Ready state after a failure are simply dropped
+	for (auto &slot : m_slots) {
+		slot.state = Slot::Free;
+	}
+	releaseFiles();
+	return result;
+}
+
+// Reaps the 'inKernel' requests still owned by the kernel after a hard failure of the ring,
+// then tears the ring down. It isn't used again (m_ready is false), and requests left in the
+// submission queue must not be submitted by a later transfer.
+void UringEngine::shutdown(int inKernel) {
+	while (inKernel > 0) {
+		io_uring_cqe *cqe = nullptr;
+		int ret = io_uring_wait_cqe(m_ring, &cqe);
+		if (ret == -EINTR || ret == -EAGAIN)
+			continue;
+		if (ret < 0) {
+			// Closing the ring below makes the kernel cancel whatever is left
+			LOG(LogLevel::ERROR) << "Cannot reap io_uring completions:" << strerror(-ret);
+			break;
+		}
+		io_uring_cqe_seen(m_ring, cqe);
+		inKernel--;
+	}
+
+	// Also drops the registered buffers and the file table
+	io_uring_queue_exit(m_ring);
+	delete m_ring;
+	m_ring = nullptr;
+	m_filesBound = false;
+	m_fixedBuffers = false;
+	m_fixedFiles = false;
+}
+
+#else // No liburing at build time: the engine is never ready and CopyWorker uses read/write.
+
+UringEngine::UringEngine(BufferRing &ring) : m_buffers(ring) {
+	LOG(LogLevel::INFO) << "Built without liburing - using read/write loop.";
+}
+
+UringEngine::~UringEngine() {}
+
+UringEngine::Result UringEngine::run(int, int, uint64_t, const DataCallback &, const ProgressCallback &, bool) {
+	return ReadFailed;
+}
+
+#endif
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "BufferRing.h"
+
+// Forward Declaration
+// Keeps liburing out of the headers so the app still builds without it.
+struct io_uring;
+
+// Asynchronous data path built on io_uring.
+// The synchronous read() -> hash -> write() loop keeps only one request in flight,
+// so the source device idles while we write and the destination idles while we read.
+// This engine keeps one chunk per BufferRing buffer in flight at once, using registered
+// (pinned) buffers and fixed files to avoid the per-request setup cost in the kernel.
+// Chunks are handed to the data callback strictly in file order so streaming
+// hashes (XXH64) produce the same result as the synchronous loop.
+class UringEngine {
+public:
+	enum Result {
+		Ok,
+		ReadFailed,
+		WriteFailed,
+		UnexpectedEOF,
+		Aborted
+	};
+
+	// Receives every chunk read from the source, in file order (used for hashing).
+	using DataCallback = std::function<void(const char *data, size_t len)>;
+	// Receives the number of bytes completed. Returning false aborts the transfer.
+	using ProgressCallback = std::function<bool(size_t bytes)>;
+
+	// Uses the buffers of 'ring' as its queue slots. The ring must outlive the engine.
+	explicit UringEngine(BufferRing &ring);
+	~UringEngine();
+
+	UringEngine(const UringEngine &) = delete;
+	UringEngine &operator=(const UringEngine &) = delete;
+
+	// False if the kernel has no io_uring support (or it is disabled by sysctl).
+	// The caller should fall back to the synchronous loop in that case.
+	bool isReady() const { return m_ready; }
+
+	// Copies 'size' bytes from fdIn to fdOut.
+	// padTail: fdOut uses O_DIRECT, so the last chunk is zero-padded to ALIGNMENT.
+	// The caller must ftruncate() the file to 'size' afterwards.
+	Result copy(int fdIn, int fdOut, uint64_t size, const DataCallback &onData, const ProgressCallback &onProgress, bool padTail = false);
+
+	// Reads 'size' bytes from fd (verification pass). Works with O_DIRECT descriptors.
+	Result read(int fd, uint64_t size, const DataCallback &onData, const ProgressCallback &onProgress);
+
+private:
+	// O_DIRECT requires read sizes to be a multiple of the logical block size
+	static constexpr size_t ALIGNMENT = BufferRing::ALIGNMENT;
+
+	struct Slot {
+		enum State {
+			Free,
+			Reading,
+			Ready, // Read finished, waiting for its turn to be hashed
+			Writing
+		};
+		char *buf = nullptr;
+		int index = 0;
+		State state = Free;
+		uint64_t offset = 0;
+		size_t len = 0;
+		size_t writeLen = 0; // len, or len rounded up to ALIGNMENT for a padded tail
+		size_t done = 0;
+	};
+
+	io_uring *m_ring = nullptr;
+	BufferRing &m_buffers;
+	std::vector<Slot> m_slots;
+	size_t m_chunkSize = 0; // Chunk size of the current transfer, taken from the ring
+	bool m_ready = false;
+	bool m_fixedBuffers = false;
+	bool m_fixedFiles = false;
+	bool m_filesBound = false; // Current transfer uses the fixed file table
+
+	Result run(int fdIn, int fdOut, uint64_t size, const DataCallback &onData, const ProgressCallback &onProgress, bool padTail);
+	void queueRead(Slot &slot, int fd, bool alignLength);
+	void queueWrite(Slot &slot, int fd);
+	void bindFiles(int fdIn, int fdOut);
+	void releaseFiles();
+	void shutdown(int inKernel);
+};
@@ -0,0 +1,66 @@
+#include <algorithm>
+
+#include "WorkStealingQueue.h"
+
+WorkStealingQueue::WorkStealingQueue(size_t workers) {
+	if (workers == 0)
+		workers = 1;
+	for (size_t i = 0; i < workers; ++i) {
+		m_queues.push_back(std::make_unique<Queue>());
+	}
+}
+
+void WorkStealingQueue::push(size_t task) {
+	m_queues[m_nextQueue]->tasks.push_back(task);
+	m_nextQueue = (m_nextQueue + 1) % m_queues.size();
+}
+
+bool WorkStealingQueue::pop(size_t worker, size_t &task, const Filter &accept) {
+	Queue &own = *m_queues[worker];
+	{
+		std::lock_guard<std::mutex> lock(own.mutex);
+		for (auto it = own.tasks.begin(); it != own.tasks.end(); ++it) {
+			if (!accept || accept(*it)) {
+				task = *it;
+				own.tasks.erase(it);
+				return true;
+			}
+		}
+	}
+	return steal(worker, task, accept);
+}
+
+bool WorkStealingQueue::empty() const {
+	for (const auto &queue : m_queues) {
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		if (!queue->tasks.empty())
+			return false;
+	}
+	return true;
+}
+
+// Takes a task from the back of another queue, trying the fullest queues first.
+bool WorkStealingQueue::steal(size_t thief, size_t &task, const Filter &accept) {
+	std::vector<std::pair<size_t, size_t>> victims; // (tasks left, queue)
+	for (size_t i = 0; i < m_queues.size(); ++i) {
+		if (i == thief)
+			continue;
+		std::lock_guard<std::mutex> lock(m_queues[i]->mutex);
+		if (!m_queues[i]->tasks.empty())
+			victims.emplace_back(m_queues[i]->tasks.size(), i);
+	}
+	std::sort(victims.begin(), victims.end(), std::greater<>());
+
+	for (const auto &victim : victims) {
+		Queue &queue = *m_queues[victim.second];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		for (auto it = queue.tasks.rbegin(); it != queue.tasks.rend(); ++it) {
+			if (!accept || accept(*it)) {
+				task = *it;
+				queue.tasks.erase(std::next(it).base());
+				return true;
+			}
+		}
+	}
+	return false;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Task queues for the file copy pool, one per worker.
+// A worker takes tasks from the front of its own queue and, once that is empty, steals
+// from the back of the fullest other queue. Only the owner and the occasional thief touch
+// a queue, so the workers rarely wait on each other's locks.
+//
+// Tasks are dealt round-robin in the order they are pushed. With a largest-first list every
+// worker starts on one of the big files, and the small ones left at the tails are what gets
+// stolen at the end, so all workers run out of work at about the same time.
+class WorkStealingQueue {
+public:
+	// Decides if a task can run now (e.g. its devices are free). Called with the queue locked;
+	// a task it accepts is removed from the queue.
+	using Filter = std::function<bool(size_t task)>;
+
+	explicit WorkStealingQueue(size_t workers);
+
+	WorkStealingQueue(const WorkStealingQueue &) = delete;
+	WorkStealingQueue &operator=(const WorkStealingQueue &) = delete;
+
+	// Adds a task (an index into the caller's task list). Not thread safe: fill the
+	// queues before starting the workers.
+	void push(size_t task);
+
+	// Next task for 'worker': its own first, then a stolen one. With a filter, the first
+	// task it accepts. Returns false if there is none, see empty() to tell the cases apart.
+	bool pop(size_t worker, size_t &task, const Filter &accept = nullptr);
+
+	// True once every queue is empty
+	bool empty() const;
+
+private:
+	struct Queue {
+		mutable std::mutex mutex;
+		std::deque<size_t> tasks;
+	};
+
+	std::vector<std::unique_ptr<Queue>> m_queues; // std::mutex can't be moved
+	size_t m_nextQueue = 0;
+
+	bool steal(size_t thief, size_t &task, const Filter &accept);
+};
@@ -13,17 +13,20 @@
 #include <iostream>
 
 #include "Config.h"
+#include "CopyWorker.h"
+#include "HashManifest.h"
 #include "LogHelper.h"
 #include "MainWindow.h"
 #include "Settings.h"
 #include "StartupHandler.h"
 
+using std::cerr;
 using std::cout;
 using std::endl;
 
 // ------- Requirements to compile
 // OpenSuse, Fedora
-// sudo zypper install cmake gcc-c++ mold lld xxhash-devel \
+// sudo zypper install cmake gcc-c++ mold lld xxhash-devel liburing-devel \
 // qt6-base-devel qt6-tools-devel qt6-widgets-devel
 // sudo zypper install qt6-linguist-devel
 
@@ -31,7 +34,7 @@ using std::endl;
 // sudo pacman -S qt6-tools
 
 // Ubuntu
-// sudo apt install cmake g++ mold lld libxxhash-dev \
+// sudo apt install cmake g++ mold lld libxxhash-dev liburing-dev \
 // qt6-base-dev qt6-base-dev-tools
 
 // ------- Compile from project root:
@@ -64,7 +67,43 @@ bool isXcbPluginAvailable() {
 }
 
 
+// Checks the files listed in hash manifests against their checksums, without a window.
+// Prints one line per file like xxhsum -c. Returns 0 if every file matches.
+int verifyManifests(int argc, char *argv[]) {
+	QCoreApplication app(argc, argv);
+	app.setOrganizationName(APP_NAME);
+	app.setApplicationName(APP_NAME);
+	Config::load();
+
+	bool allOk = true;
+	for (int i = 2; i < argc; ++i) {
+		HashManifest::VerifyResult result = HashManifest::verify(argv[i], Config::COPY_THREADS, Config::BUFFER_SIZE, cout);
+		if (!result.opened) {
+			cerr << argv[i] << ": cannot open the manifest" << endl;
+			allOk = false;
+			continue;
+		}
+		if (result.failed > 0)
+			cerr << "WARNING: " << result.failed << " computed checksums did NOT match" << endl;
+		if (result.unreadable > 0)
+			cerr << "WARNING: " << result.unreadable << " listed files could not be read" << endl;
+		if (result.skipped > 0)
+			cerr << "WARNING: " << result.skipped << " lines were skipped" << endl;
+		allOk = allOk && result.failed == 0 && result.unreadable == 0 && result.skipped == 0;
+	}
+	return allOk ? 0 : 1;
+}
+
+
 int main(int argc, char *argv[]) {
+	CopyWorker::installSigbusHandler();
+
+	// Terminal only, so it also runs without a display (e.g. a scrub from cron)
+	if (argc > 2 && std::string(argv[1]) == "verify") {
+		LogManager::init();
+		return verifyManifests(argc, argv);
+	}
+
 	// Check if we are on a Wayland session
 	// Using XCB plugin to allow window positioning which is not possible on Wayland.
 	bool isWayland = (qgetenv("XDG_SESSION_TYPE") == "wayland");
@@ -188,6 +227,8 @@ int main(int argc, char *argv[]) {
 		cout << "       " << APP_NAME << " [cp|mv] [dest dir]" << endl;
 		cout << "       " << APP_NAME << " --settings" << endl;
 		cout << "       " << APP_NAME << " --paste-to [dest dir]" << endl;
+		cout << "       " << APP_NAME << " compare [src] [dest]" << endl;
+		cout << "       " << APP_NAME << " verify [manifest]..." << endl;
 		return 0;
 	}
 